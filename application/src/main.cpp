@@ -1,21 +1,32 @@
+#include "nes/core/trace.h"
 #include "nes/nes.h"
 
+#include <filesystem>
 #include <fstream>
 
+using namespace n_e_s::core;
 using namespace n_e_s::nes;
 
 int main(int argc, char **argv) {
-    if (argc != 2) {
+    // Usage: application <rom> [trace.json]
+    if (argc != 2 && argc != 3) {
         return 1;
     }
 
     Nes nes;
-    std::ifstream fs(argv[1], std::ios::binary);
-    nes.load_rom(fs);
+    nes.load_rom(std::filesystem::path(argv[1]));
+
+    Trace::enable(argc == 3);
 
     for (uint32_t i = 0; i < 10'000'000; ++i) {
         nes.execute();
     }
 
+    if (argc == 3) {
+        Trace::enable(false);
+        std::ofstream trace(argv[2]);
+        Trace::write_json(trace);
+    }
+
     return 0;
 }
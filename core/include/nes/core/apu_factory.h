@@ -1,13 +1,15 @@
 #pragma once
 
 #include "nes/core/iapu.h"
+#include "nes/core/ines_header.h"
 
 #include <memory>
 
 namespace n_e_s::core {
 class ApuFactory {
 public:
-    [[nodiscard]] static std::unique_ptr<IApu> create();
+    [[nodiscard]] static std::unique_ptr<IApu> create(
+            Timing timing = Timing::Ntsc);
 };
 
 } // namespace n_e_s::core
\ No newline at end of file
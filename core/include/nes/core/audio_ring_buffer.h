@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+namespace n_e_s::core {
+
+#ifdef _MSC_VER
+// The padding from the aligned indices is intended.
+#pragma warning(push)
+#pragma warning(disable : 4324)
+#endif
+
+// Hands samples from the emulation thread to an audio thread.
+//
+// One thread may push and one other thread may pop at the same time. Both
+// finish in a bounded number of steps without locking, so popping is safe
+// from a real-time audio callback.
+class AudioRingBuffer {
+public:
+    // The capacity is rounded up to a power of two.
+    explicit AudioRingBuffer(std::size_t capacity);
+
+    AudioRingBuffer(const AudioRingBuffer &) = delete;
+    AudioRingBuffer &operator=(const AudioRingBuffer &) = delete;
+
+    // Producer. Samples that don't fit are dropped and counted as overrun.
+    // Returns the number of samples pushed.
+    std::size_t push(std::span<const int16_t> samples);
+
+    // Consumer. Fills dst, padding with silence and counting the missing
+    // samples as underrun if there isn't enough. Returns the number of
+    // samples popped.
+    std::size_t pop(std::span<int16_t> dst);
+
+    // Either side may call these, but the result may be stale by the time
+    // it's returned.
+    [[nodiscard]] std::size_t size() const;
+    [[nodiscard]] std::size_t capacity() const {
+        return mask_ + 1;
+    }
+    [[nodiscard]] uint64_t underruns() const {
+        return underruns_.load(std::memory_order_relaxed);
+    }
+    [[nodiscard]] uint64_t overruns() const {
+        return overruns_.load(std::memory_order_relaxed);
+    }
+
+    // Dynamic rate control, for the producer. Returns sample_rate nudged by
+    // at most max_deviation so that producing at it brings the buffer back
+    // towards target_size. The deviation is small enough to not be heard
+    // as a change in pitch.
+    [[nodiscard]] uint32_t adjusted_sample_rate(uint32_t sample_rate,
+            std::size_t target_size,
+            double max_deviation = 0.005) const;
+
+private:
+    static constexpr std::size_t kCacheLine{64};
+
+    const std::size_t mask_;
+    const std::unique_ptr<int16_t[]> samples_;
+
+    // The positions are free running, so that a full buffer can be told
+    // from an empty one. What each side writes lives on its own cache line
+    // to not bounce between the threads.
+    alignas(kCacheLine) std::atomic<std::size_t> write_{0};
+    std::atomic<uint64_t> overruns_{0};
+    alignas(kCacheLine) std::atomic<std::size_t> read_{0};
+    std::atomic<uint64_t> underruns_{0};
+};
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+} // namespace n_e_s::core
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "nes/core/imos6502.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+namespace n_e_s::core {
+
+// Counts executions and cycles per opcode, per address mode and per pc by
+// watching the CpuState after every cpu cycle.
+//
+// Cycles are attributed to an instruction once the next one is decoded, so
+// interrupt sequences are counted towards the instruction they followed.
+class CpuProfiler {
+public:
+    struct Counter {
+        uint64_t executions{};
+        uint64_t cycles{};
+    };
+
+    // A pc range that was jumped back to from its end address.
+    struct HotLoop {
+        uint16_t start_pc{};
+        uint16_t end_pc{};
+        uint64_t iterations{};
+        uint64_t cycles{}; // Cycles spent on instructions inside the range.
+    };
+
+    CpuProfiler();
+
+    // Shall be called after every cpu cycle.
+    void sample(const CpuState &state);
+
+    void clear();
+
+    [[nodiscard]] const Counter &opcode(uint8_t opcode) const;
+    [[nodiscard]] const Counter &address_mode(AddressMode address_mode) const;
+    [[nodiscard]] const Counter &pc(uint16_t pc) const;
+
+    // Returns at most max_count loops, the ones with the most cycles first.
+    [[nodiscard]] std::vector<HotLoop> hot_loops(std::size_t max_count) const;
+
+    // Writes all non-zero counters and the hot loops as
+    // kind,key,executions,cycles
+    // where executions are the iterations for the loops.
+    void write_csv(std::ostream &os) const;
+
+private:
+    static constexpr std::size_t kAddressModes{
+            static_cast<std::size_t>(AddressMode::Indirect) + 1};
+
+    std::array<Counter, 256> opcodes_{};
+    std::array<Counter, kAddressModes> address_modes_{};
+    std::vector<Counter> pcs_;
+
+    // Backward jumps and taken branches, keyed by (target, source).
+    std::map<std::pair<uint16_t, uint16_t>, uint64_t> loop_edges_;
+
+    // The instruction currently executing.
+    std::optional<Opcode> opcode_;
+    uint16_t start_pc_{};
+    uint64_t start_cycle_{};
+
+    void record(uint64_t next_start_cycle, uint16_t next_pc);
+};
+
+} // namespace n_e_s::core
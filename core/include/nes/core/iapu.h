@@ -2,33 +2,77 @@
 
 #include <cstdint>
 #include <functional>
+#include <optional>
+#include <span>
 
 namespace n_e_s::core {
 
 class IApu {
 public:
+    enum class Channel { Pulse1, Pulse2, Triangle, Noise, Dmc };
+
+    // How well the output is band-limited when it's resampled to the sample
+    // rate. Higher quality costs more per change in a channel's output.
+    enum class ResamplingQuality { Low, Medium, High };
+
     virtual ~IApu() = default;
 
     virtual uint8_t read_byte(uint16_t addr) = 0;
     virtual void write_byte(uint16_t addr, uint8_t byte) = 0;
 
-    virtual void execute() = 0;
-
-    virtual void set_sample_handler(
-            const std::function<void(int8_t)> &audio_handler) = 0;
-
-    // Set sample handlers for individual channels
-    // (eg. for debugging, custom mixing etc)
-    virtual void set_sample_handler_pulse_1(
-            const std::function<void(int8_t)> &audio_handler) = 0;
-    virtual void set_sample_handler_pulse_2(
-            const std::function<void(int8_t)> &audio_handler) = 0;
-    virtual void set_sample_handler_triangle(
-            const std::function<void(int8_t)> &audio_handler) = 0;
-    virtual void set_sample_handler_noise(
-            const std::function<void(int8_t)> &audio_handler) = 0;
-    virtual void set_sample_handler_pcm(
-            const std::function<void(int8_t)> &audio_handler) = 0;
+    // Reads what read_byte would as of the last time the apu ran, without
+    // clearing anything or running the apu.
+    [[nodiscard]] virtual uint8_t peek_byte(uint16_t addr) const = 0;
+
+    // Runs the apu until it has run cpu_cycle cpu cycles since power on.
+    // The apu keeps track of its own time, so it only has to be run when
+    // its output is needed.
+    virtual void run_until(uint64_t cpu_cycle) = 0;
+
+    // Register accesses first run the apu to the cycle returned by the
+    // clock, if set, so that they happen at the right time.
+    virtual void set_cpu_clock(const std::function<uint64_t()> &cpu_clock) = 0;
+
+    // The rate samples are delivered to the sample sinks at. Defaults to
+    // 44.1 kHz. Changes apply from the next block without a click, so the
+    // rate may be nudged continuously to control how fast samples are
+    // produced.
+    virtual void set_sample_rate(uint32_t sample_rate) = 0;
+
+    // Defaults to medium. May be changed at any time.
+    virtual void set_resampling_quality(ResamplingQuality quality) = 0;
+
+    // Called with the IrqSource bits of the apu when they're asserted or
+    // released.
+    virtual void set_irq_handler(
+            const std::function<void(uint8_t, bool)> &irq_handler) = 0;
+
+    // Called with the IrqSource bits of the apu and the cpu cycle they'll be
+    // asserted at unless the apu releases them before then.
+    virtual void set_irq_scheduler(
+            const std::function<void(uint8_t, uint64_t)> &irq_scheduler) = 0;
+
+    // The dmc reads its samples from cpu memory with the reader, in a dma
+    // that stalls the cpu. The scheduler is told the cpu cycle the next read
+    // is due at, or nullopt if none is, and dma must be called then.
+    virtual void set_dma_reader(
+            const std::function<uint8_t(uint16_t)> &dma_reader) = 0;
+    virtual void set_dma_scheduler(
+            const std::function<void(std::optional<uint64_t>)>
+                    &dma_scheduler) = 0;
+    virtual void dma(uint64_t cpu_cycle) = 0;
+
+    // Receives every sample produced since the last call, a couple of ms
+    // worth at a time. The span is only valid during the call.
+    using SampleSink = std::function<void(std::span<const int16_t>)>;
+
+    // The mixed output. Nothing is synthesised for outputs without a sink,
+    // so pass an empty sink to stop listening.
+    virtual void set_sample_sink(const SampleSink &sink) = 0;
+
+    // A single channel on its own, e.g. for debugging or custom mixing.
+    virtual void set_channel_sample_sink(Channel channel,
+            const SampleSink &sink) = 0;
 };
 
 } // namespace n_e_s::core
@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <span>
 #include <vector>
 
 namespace n_e_s::core {
@@ -14,6 +15,40 @@ public:
 
     virtual uint8_t read_byte(uint16_t addr) const = 0;
     virtual void write_byte(uint16_t addr, uint8_t byte) = 0;
+
+    // Block accesses of addr and the addresses following it, all of which
+    // must be in range. The defaults go through read_byte and write_byte.
+    virtual void read_block(uint16_t addr, std::span<uint8_t> dst) const {
+        for (uint8_t &byte : dst) {
+            byte = read_byte(addr++);
+        }
+    }
+    virtual void write_block(uint16_t addr, std::span<const uint8_t> src) {
+        for (const uint8_t byte : src) {
+            write_byte(addr++, byte);
+        }
+    }
+
+    // Like read_block, but without any side effects. Mem banks where reading
+    // has side effects must override this.
+    virtual void peek_block(uint16_t addr, std::span<uint8_t> dst) const {
+        read_block(addr, dst);
+    }
+    [[nodiscard]] virtual uint8_t peek_byte(uint16_t addr) const {
+        uint8_t byte{};
+        peek_block(addr, std::span(&byte, 1));
+        return byte;
+    }
+
+    // Returns the memory backing addr and the addresses following it if it's
+    // plain memory that may be accessed directly, otherwise an empty span.
+    [[nodiscard]] virtual std::span<uint8_t> direct_memory(uint16_t) {
+        return {};
+    }
+
+    // Called with the mmu's open bus latch when the mem bank is added to it,
+    // for mem banks with write-only addresses which read the open bus.
+    virtual void set_open_bus(const uint8_t *) {}
 };
 
 using MemBankList = std::vector<std::unique_ptr<IMemBank>>;
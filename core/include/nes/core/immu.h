@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <span>
 
 #include "nes/core/imembank.h"
 
@@ -16,6 +17,51 @@ public:
 
     virtual uint8_t read_byte(uint16_t addr) const = 0;
     virtual void write_byte(uint16_t addr, uint8_t byte) = 0;
+
+    // Block accesses wrap around from 0xFFFF to 0x0000. The defaults go
+    // through read_byte and write_byte, so implementations where reading has
+    // side effects must override peek_block.
+    virtual void read_block(uint16_t addr, std::span<uint8_t> dst) const {
+        for (uint8_t &byte : dst) {
+            byte = read_byte(addr++);
+        }
+    }
+    virtual void write_block(uint16_t addr, std::span<const uint8_t> src) {
+        for (const uint8_t byte : src) {
+            write_byte(addr++, byte);
+        }
+    }
+    virtual void peek_block(uint16_t addr, std::span<uint8_t> dst) const {
+        read_block(addr, dst);
+    }
+
+    // Reads a byte without any side effects, for debuggers and tracing.
+    [[nodiscard]] virtual uint8_t peek_byte(uint16_t addr) const {
+        uint8_t byte{};
+        peek_block(addr, std::span(&byte, 1));
+        return byte;
+    }
+
+    // Returns the memory backing addr and the addresses following it if the
+    // mem bank at addr allows direct access, otherwise an empty span. The
+    // memory is only valid until the mem banks are replaced.
+    [[nodiscard]] virtual std::span<uint8_t> direct_memory(uint16_t) {
+        return {};
+    }
+
+    // The open bus latch, for keeping it up to date when accessing
+    // direct_memory without going through the mmu. nullptr if there's none.
+    [[nodiscard]] virtual uint8_t *open_bus() {
+        return nullptr;
+    }
+
+    // Accesses to addresses without a mem bank read the open bus value (the
+    // last byte seen on the bus), ignore writes and are counted. In strict
+    // mode they throw InvalidAddress instead, which is useful for debugging.
+    virtual void set_strict(bool) {}
+    [[nodiscard]] virtual uint64_t invalid_access_count() const {
+        return 0;
+    }
 };
 
 } // namespace n_e_s::core
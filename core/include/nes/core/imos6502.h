@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <functional>
 #include <optional>
 
 #include "nes/core/icpu.h"
@@ -19,6 +20,13 @@ enum CpuFlag : uint8_t {
     N_FLAG = 1u << 7u, // negative
 };
 
+// Things that can assert the irq line. Used as bitmasks.
+enum IrqSource : uint8_t {
+    IRQ_APU_FRAME_COUNTER = 1u << 0u,
+    IRQ_APU_DMC = 1u << 1u,
+    IRQ_MAPPER = 1u << 2u,
+};
+
 struct CpuRegisters {
     uint16_t pc; // program counter
     uint8_t sp; // stack pointer
@@ -44,6 +52,35 @@ public:
     [[nodiscard]] virtual const CpuState &state() const = 0;
 
     virtual void set_nmi(bool nmi) = 0;
+
+    // The irq line is asserted as long as any source asserts it. It's polled
+    // between instructions using the I flag as it was before the last cycle
+    // of the instruction, so e.g. CLI only lets irqs through after the next
+    // instruction.
+    //
+    // Asserting or releasing sources cancels their scheduled asserts.
+    virtual void set_irq(uint8_t sources, bool asserted) = 0;
+
+    // Asserts the irq line for the sources once the cpu reaches cycle, so
+    // sources that know when they'll fire don't have to be clocked every
+    // cycle to raise the line in time.
+    virtual void schedule_irq(uint8_t sources, uint64_t cycle) = 0;
+
+    // Returns the sources currently asserting the irq line.
+    [[nodiscard]] virtual uint8_t irq_sources() const = 0;
+
+    // Stalls the cpu while the dmc reads a sample byte once it reaches cycle,
+    // calling the dma handler as the stall starts so that the read can
+    // happen then. Replaces the earlier schedule, if any, and nullopt
+    // cancels it.
+    virtual void schedule_dma(std::optional<uint64_t> cycle) = 0;
+    virtual void set_dma_handler(const std::function<void()> &dma_handler) = 0;
+
+    // Idle loops (a load or BIT followed by a branch back to it, or a jump to
+    // itself) are run without decoding them once found. This gives the same
+    // register, bus and cycle behaviour at every instruction boundary.
+    // Enabled by default.
+    virtual void set_idle_loop_detection(bool enabled) = 0;
 };
 
 } // namespace n_e_s::core
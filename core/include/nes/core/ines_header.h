@@ -4,28 +4,138 @@
 
 namespace n_e_s::core {
 
-enum class Mirroring { Horizontal, Vertical };
+enum class Mirroring {
+    Horizontal,
+    Vertical,
+    SingleScreenLower,
+    SingleScreenUpper,
+    FourScreen,
+};
+
+enum class Timing {
+    Ntsc,
+    Pal,
+    MultiRegion,
+    Dendy,
+};
 
+// https://www.nesdev.org/wiki/INES and https://www.nesdev.org/wiki/NES_2.0
 struct INesHeader {
     uint8_t nes[4]{'N', 'E', 'S', 26}; // NES + MS-DOS EOF
     uint8_t prg_rom_size; // in 16 KB units.
     uint8_t chr_rom_size; // in 8 KB units.
     uint8_t flags_6;
     uint8_t flags_7;
-    uint8_t prg_ram_size; // in 8 KB units.
-    uint8_t flags_9;
-    uint8_t flags_10;
-    uint8_t zeros[5]{0};
-
-    [[nodiscard]] constexpr uint8_t mapper() const {
-        uint8_t mapper = static_cast<uint8_t>(flags_6 & 0xF0u) >> 4u;
-        mapper |= flags_7 & 0xF0u;
+    uint8_t flags_8; // iNes: prg ram, 8 KB units. 2.0: mapper msb, submapper.
+    uint8_t flags_9; // iNes: tv system. 2.0: prg and chr rom size msb.
+    uint8_t flags_10; // 2.0: prg ram and nvram shift counts.
+    uint8_t flags_11{0}; // 2.0: chr ram and nvram shift counts.
+    uint8_t flags_12{0}; // 2.0: timing.
+    uint8_t flags_13{0};
+    uint8_t flags_14{0};
+    uint8_t flags_15{0};
+
+    [[nodiscard]] constexpr bool is_nes2() const {
+        return (flags_7 & 0x0Cu) == 0x08u;
+    }
+
+    [[nodiscard]] constexpr uint16_t mapper() const {
+        uint16_t mapper = static_cast<uint8_t>(flags_6 & 0xF0u) >> 4u;
+        if (is_nes2()) {
+            mapper |= static_cast<uint16_t>((flags_8 & 0x0Fu) << 8u);
+            mapper |= flags_7 & 0xF0u;
+        } else if (!has_garbage_in_padding()) {
+            mapper |= flags_7 & 0xF0u;
+        }
         return mapper;
     }
 
+    [[nodiscard]] constexpr uint8_t submapper() const {
+        return is_nes2() ? static_cast<uint8_t>(flags_8 >> 4u) : 0u;
+    }
+
+    [[nodiscard]] constexpr uint64_t prg_rom_bytes() const {
+        const unsigned msb = is_nes2() ? flags_9 & 0x0Fu : 0u;
+        return rom_bytes(prg_rom_size, msb, 16 * 1024);
+    }
+
+    [[nodiscard]] constexpr uint64_t chr_rom_bytes() const {
+        const unsigned msb = is_nes2() ? flags_9 >> 4u : 0u;
+        return rom_bytes(chr_rom_size, msb, 8 * 1024);
+    }
+
+    // Ram that is lost on power off.
+    [[nodiscard]] constexpr uint32_t prg_ram_bytes() const {
+        if (is_nes2()) {
+            return ram_bytes(flags_10 & 0x0Fu);
+        }
+        // For compatibility reasons, 0 ram means 8 KB.
+        return (flags_8 == 0 ? 1u : flags_8) * 8u * 1024u;
+    }
+
+    // Battery backed ram.
+    [[nodiscard]] constexpr uint32_t prg_nvram_bytes() const {
+        if (is_nes2()) {
+            return ram_bytes(flags_10 >> 4u);
+        }
+        return has_battery() ? prg_ram_bytes() : 0u;
+    }
+
+    [[nodiscard]] constexpr uint32_t chr_ram_bytes() const {
+        if (is_nes2()) {
+            return ram_bytes(flags_11 & 0x0Fu);
+        }
+        return chr_rom_size == 0 ? 8u * 1024u : 0u;
+    }
+
+    [[nodiscard]] constexpr bool has_battery() const {
+        return flags_6 & 0x02u;
+    }
+
+    // A 512 byte trainer precedes the prg rom.
+    [[nodiscard]] constexpr bool has_trainer() const {
+        return flags_6 & 0x04u;
+    }
+
     [[nodiscard]] constexpr Mirroring mirroring() const {
+        if (flags_6 & 0x08u) {
+            return Mirroring::FourScreen;
+        }
         return flags_6 & 0x01u ? Mirroring::Vertical : Mirroring::Horizontal;
     }
+
+    [[nodiscard]] constexpr Timing timing() const {
+        if (is_nes2()) {
+            return static_cast<Timing>(flags_12 & 0x03u);
+        }
+        return flags_9 & 0x01u ? Timing::Pal : Timing::Ntsc;
+    }
+
+private:
+    // Headers written by old tools sometimes have e.g. "DiskDude!" in the
+    // bytes after the prg ram size, making the upper mapper nibble garbage.
+    [[nodiscard]] constexpr bool has_garbage_in_padding() const {
+        return (flags_7 & 0x0Cu) == 0x04u ||
+               (flags_12 | flags_13 | flags_14 | flags_15) != 0;
+    }
+
+    // Sizes with an msb of $F use exponent-multiplier notation,
+    // 2^E * (MM * 2 + 1).
+    [[nodiscard]] static constexpr uint64_t rom_bytes(uint8_t lsb,
+            unsigned msb,
+            uint64_t unit) {
+        if (msb == 0x0Fu) {
+            const unsigned exponent = lsb >> 2u;
+            const unsigned multiplier = (lsb & 0x03u) * 2u + 1u;
+            return exponent < 48 ? (uint64_t{1} << exponent) * multiplier
+                                 : UINT64_MAX;
+        }
+        return ((uint64_t{msb} << 8u) | lsb) * unit;
+    }
+
+    [[nodiscard]] static constexpr uint32_t ram_bytes(unsigned shift) {
+        return shift == 0 ? 0u : 64u << shift;
+    }
 };
 
 } // namespace n_e_s::core
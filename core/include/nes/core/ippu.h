@@ -20,6 +20,13 @@ public:
 
     virtual void set_nmi_handler(const std::function<void()> &nmi_handler) = 0;
 
+    // Called when ppu address line 12 rises while rendering, which is how
+    // e.g. the mmc3 counts scanlines. The rise is computed from the pattern
+    // tables in use rather than watched on every fetch, so this is called at
+    // most once per scanline.
+    virtual void set_a12_rise_handler(
+            const std::function<void()> &a12_rise_handler) = 0;
+
     [[nodiscard]] virtual uint16_t scanline() const = 0;
     [[nodiscard]] virtual uint16_t cycle() const = 0;
 };
@@ -2,6 +2,10 @@
 
 #include "nes/core/ines_header.h"
 
+#include <cstdint>
+#include <functional>
+#include <span>
+
 namespace n_e_s::core {
 
 class IRom {
@@ -18,6 +22,26 @@ public:
     [[nodiscard]] virtual uint8_t ppu_read_byte(uint16_t addr) const = 0;
     virtual void ppu_write_byte(uint16_t addr, uint8_t byte) = 0;
 
+    // Reads addr and the addresses following it, all of which must be in
+    // range. Reading a rom never has side effects, so these are also used for
+    // peeking.
+    virtual void cpu_read_block(uint16_t addr, std::span<uint8_t> dst) const {
+        for (uint8_t &byte : dst) {
+            byte = cpu_read_byte(addr++);
+        }
+    }
+    virtual void ppu_read_block(uint16_t addr, std::span<uint8_t> dst) const {
+        for (uint8_t &byte : dst) {
+            byte = ppu_read_byte(addr++);
+        }
+    }
+
+    // Called when ppu address line 12 rises, see IPpu::set_a12_rise_handler.
+    virtual void ppu_a12_rise() {}
+
+    // Mappers with an irq output report changes to it through the handler.
+    virtual void set_irq_handler(const std::function<void(bool)> &) {}
+
     const INesHeader &header() const {
         return header_;
     }
@@ -5,12 +5,14 @@
 
 namespace n_e_s::core {
 
+class IApu;
 class IPpu;
 class IRom;
 
 class MemBankFactory {
 public:
     [[nodiscard]] static MemBankList create_nes_mem_banks(IPpu *ppu,
+            IApu *apu,
             IRom *rom,
             INesController *controller1,
             INesController *controller2);
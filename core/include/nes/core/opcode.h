@@ -874,5 +874,6 @@ struct Opcode {
 }
 
 [[nodiscard]] std::string_view to_string(const Family family);
+[[nodiscard]] std::string_view to_string(const AddressMode address_mode);
 
 } // namespace n_e_s::core
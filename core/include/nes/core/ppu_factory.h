@@ -1,6 +1,7 @@
 #pragma once
 
 #include "nes/core/immu.h"
+#include "nes/core/ines_header.h"
 #include "nes/core/ippu.h"
 
 #include <memory>
@@ -10,7 +11,8 @@ namespace n_e_s::core {
 class PpuFactory {
 public:
     [[nodiscard]] static std::unique_ptr<IPpu> create(PpuRegisters *registers,
-            IMmu *mmu);
+            IMmu *mmu,
+            Timing timing = Timing::Ntsc);
 };
 
 } // namespace n_e_s::core
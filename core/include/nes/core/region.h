@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace n_e_s::core {
+
+// The timing of the consoles sold in different regions, for parameterising
+// the ppu, apu and the system clock at compile time.
+// https://www.nesdev.org/wiki/Cycle_reference_chart
+
+struct Ntsc {
+    static constexpr uint32_t kMasterClockRate{21477272};
+    static constexpr uint32_t kCpuClockRate{1789773};
+    // Master clocks per cpu cycle and ppu dot.
+    static constexpr uint32_t kCpuDivider{12};
+    static constexpr uint32_t kPpuDivider{4};
+
+    // Idle scanlines between the visible ones and vblank, and vblank itself.
+    static constexpr uint16_t kPostRenderScanlines{1};
+    static constexpr uint16_t kVBlankScanlines{20};
+    static constexpr bool kSkipsDotOnOddFrames{true};
+
+    // In cpu cycles. The events are the quarter frames, the frame irq and
+    // the ends of the 4- and 5-step sequences, see Apu::clock_frame_counter.
+    static constexpr std::array<uint32_t, 7> kFrameCounterEvents{
+            7457, 14913, 22371, 29829, 29830, 37281, 37282};
+    static constexpr std::array<uint16_t, 16> kNoisePeriods{4, 8, 16, 32,
+            64, 96, 128, 160, 202, 254, 380, 508, 762, 1016, 2034, 4068};
+    static constexpr std::array<uint16_t, 16> kDmcPeriods{428, 380, 340,
+            320, 286, 254, 226, 214, 190, 160, 142, 128, 106, 84, 72, 54};
+};
+
+struct Pal {
+    static constexpr uint32_t kMasterClockRate{26601712};
+    static constexpr uint32_t kCpuClockRate{1662607};
+    static constexpr uint32_t kCpuDivider{16};
+    static constexpr uint32_t kPpuDivider{5};
+
+    static constexpr uint16_t kPostRenderScanlines{1};
+    static constexpr uint16_t kVBlankScanlines{70};
+    static constexpr bool kSkipsDotOnOddFrames{false};
+
+    static constexpr std::array<uint32_t, 7> kFrameCounterEvents{
+            8313, 16627, 24939, 33253, 33254, 41565, 41566};
+    static constexpr std::array<uint16_t, 16> kNoisePeriods{4, 8, 14, 30,
+            60, 88, 118, 148, 188, 236, 354, 472, 708, 944, 1890, 3778};
+    static constexpr std::array<uint16_t, 16> kDmcPeriods{398, 354, 316,
+            298, 276, 236, 210, 198, 176, 148, 132, 118, 98, 78, 66, 50};
+};
+
+// The famiclone sold in Russia. Its ppu renders PAL frames, but vblank is
+// as long as on NTSC so that NTSC games run on it, and its apu is NTSC's
+// running a bit slower.
+struct Dendy {
+    static constexpr uint32_t kMasterClockRate{26601712};
+    static constexpr uint32_t kCpuClockRate{1773448};
+    static constexpr uint32_t kCpuDivider{15};
+    static constexpr uint32_t kPpuDivider{5};
+
+    static constexpr uint16_t kPostRenderScanlines{51};
+    static constexpr uint16_t kVBlankScanlines{20};
+    static constexpr bool kSkipsDotOnOddFrames{false};
+
+    static constexpr std::array<uint32_t, 7> kFrameCounterEvents{
+            Ntsc::kFrameCounterEvents};
+    static constexpr std::array<uint16_t, 16> kNoisePeriods{
+            Ntsc::kNoisePeriods};
+    static constexpr std::array<uint16_t, 16> kDmcPeriods{Ntsc::kDmcPeriods};
+};
+
+} // namespace n_e_s::core
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "nes/core/ines_header.h"
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace n_e_s::core {
+
+namespace detail {
+
+constexpr std::array<uint32_t, 256> make_crc32_table() {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < table.size(); ++i) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1u) ? (crc >> 1u) ^ 0xEDB8'8320u : crc >> 1u;
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+inline constexpr std::array<uint32_t, 256> kCrc32Table{make_crc32_table()};
+
+} // namespace detail
+
+// The crc32 used by rom databases, continuing from crc if given.
+[[nodiscard]] constexpr uint32_t crc32(std::span<const uint8_t> bytes,
+        uint32_t crc = 0) {
+    crc = ~crc;
+    for (const uint8_t byte : bytes) {
+        crc = detail::kCrc32Table[(crc ^ byte) & 0xFFu] ^ (crc >> 8u);
+    }
+    return ~crc;
+}
+
+// What a rom database knows about a rom, keyed by the crc32 of its prg and
+// chr rom.
+struct RomDatabaseEntry {
+    uint32_t crc{};
+    uint16_t mapper{};
+    uint8_t submapper{};
+    Mirroring mirroring{Mirroring::Horizontal};
+    uint32_t prg_ram_bytes{};
+    uint32_t prg_nvram_bytes{}; // Battery backed.
+    uint32_t chr_ram_bytes{};
+    Timing timing{Timing::Ntsc};
+
+    // Rewrites the header as a NES 2.0 header describing this rom, keeping
+    // its rom sizes and trainer.
+    constexpr void apply_to(INesHeader &header) const {
+        if (!header.is_nes2()) {
+            header.flags_9 = 0; // Rom size msb in NES 2.0.
+            // May hold e.g. "DiskDude!", which would be read as NES 2.0
+            // fields.
+            header.flags_13 = 0;
+            header.flags_14 = 0;
+            header.flags_15 = 0;
+        }
+
+        uint8_t flags_6 = header.flags_6 & 0x04u;
+        flags_6 |= static_cast<uint8_t>((mapper & 0x0Fu) << 4u);
+        flags_6 |= prg_nvram_bytes != 0 ? 0x02u : 0x00u;
+        flags_6 |= mirroring == Mirroring::Vertical ? 0x01u : 0x00u;
+        flags_6 |= mirroring == Mirroring::FourScreen ? 0x08u : 0x00u;
+        header.flags_6 = flags_6;
+        header.flags_7 = static_cast<uint8_t>(
+                (mapper & 0xF0u) | 0x08u | (header.flags_7 & 0x03u));
+        header.flags_8 = static_cast<uint8_t>(
+                (submapper << 4u) | ((mapper >> 8u) & 0x0Fu));
+        header.flags_10 = static_cast<uint8_t>(
+                ram_shift(prg_ram_bytes) | ram_shift(prg_nvram_bytes) << 4u);
+        header.flags_11 = ram_shift(chr_ram_bytes);
+        header.flags_12 = static_cast<uint8_t>(timing);
+    }
+
+private:
+    // NES 2.0 stores ram sizes as 64 << shift, or 0 for no ram.
+    [[nodiscard]] static constexpr uint8_t ram_shift(uint32_t bytes) {
+        if (bytes == 0) {
+            return 0;
+        }
+        return static_cast<uint8_t>(std::countr_zero(bytes) - 6);
+    }
+};
+
+// An open addressing hash table built at compile time. Crcs are already
+// evenly distributed, so their low bits are used as the hash, and the table
+// is kept at most half full so lookups only probe a slot or two.
+template <std::size_t N>
+class RomDatabase {
+public:
+    constexpr explicit RomDatabase(
+            const std::array<RomDatabaseEntry, N> &entries) {
+        for (const RomDatabaseEntry &entry : entries) {
+            std::size_t slot = entry.crc & kMask;
+            while (used_[slot]) {
+                slot = (slot + 1) & kMask;
+            }
+            slots_[slot] = entry;
+            used_[slot] = true;
+        }
+    }
+
+    [[nodiscard]] constexpr const RomDatabaseEntry *find(uint32_t crc) const {
+        for (std::size_t slot = crc & kMask; used_[slot];
+                slot = (slot + 1) & kMask) {
+            if (slots_[slot].crc == crc) {
+                return &slots_[slot];
+            }
+        }
+        return nullptr;
+    }
+
+private:
+    static constexpr std::size_t kCapacity{std::bit_ceil(N * 2 + 1)};
+    static constexpr std::size_t kMask{kCapacity - 1};
+
+    std::array<RomDatabaseEntry, kCapacity> slots_{};
+    std::array<bool, kCapacity> used_{};
+};
+
+// Looks the crc32 of a rom's prg and chr rom up in the database compiled
+// into the emulator. Returns nullptr if the rom isn't in it.
+[[nodiscard]] const RomDatabaseEntry *find_in_rom_database(uint32_t crc);
+
+// False if no database was compiled in, so there's no need to hash roms.
+[[nodiscard]] bool has_rom_database();
+
+} // namespace n_e_s::core
@@ -2,6 +2,8 @@
 
 #include "nes/core/irom.h"
 
+#include <cstddef>
+#include <filesystem>
 #include <iosfwd>
 #include <memory>
 
@@ -11,6 +13,18 @@ class RomFactory {
 public:
     [[nodiscard]] static std::unique_ptr<IRom> from_bytes(
             std::istream &bytestream);
+
+    // Memory maps the file where supported and reads the rom from the
+    // mapping instead of copying it. Battery backed prg ram is kept in
+    // save_path if it isn't empty, otherwise it's lost with the rom like
+    // all other prg ram.
+    [[nodiscard]] static std::unique_ptr<IRom> from_file(
+            const std::filesystem::path &path,
+            const std::filesystem::path &save_path = {});
+
+    // Roms with identical contents share their prg and chr rom, no matter
+    // how they were loaded. This is the number of distinct roms loaded.
+    [[nodiscard]] static std::size_t cached_image_count();
 };
 
 } // namespace n_e_s::core
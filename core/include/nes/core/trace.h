@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <ostream>
+
+namespace n_e_s::core {
+
+// Records Chrome trace events (loadable in chrome://tracing and Perfetto).
+//
+// Every thread appends to its own buffer, so recording never takes a lock.
+// When tracing is disabled, recording is a single relaxed atomic load.
+//
+// Event names must outlive the trace, in practice they should be string
+// literals.
+class Trace {
+public:
+    static void enable(bool enabled);
+    [[nodiscard]] static bool enabled() {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    // These record unconditionally, so check enabled() first.
+    static void begin(const char *name);
+    static void end(const char *name);
+    static void instant(const char *name);
+
+    // Writes all events recorded so far as trace-event JSON. Tracing should
+    // be disabled before calling this if other threads are still recording.
+    static void write_json(std::ostream &os);
+
+    // Drops all recorded events. Must not race with recording threads.
+    static void clear();
+
+private:
+    inline static std::atomic<bool> enabled_{false};
+};
+
+// Records a begin event on construction and a matching end event on
+// destruction if tracing was enabled when the scope was entered.
+class TraceScope {
+public:
+    explicit TraceScope(const char *name)
+            : name_(Trace::enabled() ? name : nullptr) {
+        if (name_ != nullptr) {
+            Trace::begin(name_);
+        }
+    }
+
+    ~TraceScope() {
+        if (name_ != nullptr) {
+            Trace::end(name_);
+        }
+    }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+    const char *const name_;
+};
+
+} // namespace n_e_s::core
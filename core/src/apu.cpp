@@ -1,66 +1,460 @@
 #include "apu.h"
 
+#include "nes/core/imos6502.h"
+#include "nes/core/trace.h"
+
+#include <algorithm>
+
 namespace n_e_s::core {
+namespace {
+
+// Samples are handed out every this many cpu cycles, about 2.3 ms.
+constexpr uint32_t kAudioFrameCycles{4096};
+
+// The lookup tables from https://www.nesdev.org/wiki/APU_Mixer, scaled so
+// that all channels at full volume add up to about 28000. The pulses are
+// looked up by their summed levels, and the triangle, noise and dmc by
+// 3 * triangle + 2 * noise + dmc.
+constexpr double kMixScale{28000.0};
+
+// out = a / (b / n + 100), and silence at n = 0.
+template <std::size_t Size>
+constexpr std::array<int32_t, Size> make_mix_table(double a, double b) {
+    std::array<int32_t, Size> table{};
+    for (std::size_t n = 1; n < Size; ++n) {
+        const double out = a / (b / static_cast<double>(n) + 100.0);
+        table[n] = static_cast<int32_t>(out * kMixScale + 0.5);
+    }
+    return table;
+}
+
+constexpr auto kPulseTable = make_mix_table<31>(95.52, 8128.0);
+constexpr auto kTndTable = make_mix_table<203>(163.67, 24329.0);
+
+// Channels on their own are scaled to about the full range.
+constexpr std::array<int32_t, 5> kChannelScale{2048, 2048, 2048, 2048, 256};
+
+} // namespace
+
+template <typename Region>
+Apu<Region>::Apu() = default;
+
+template <typename Region>
+uint8_t Apu<Region>::read_byte(uint16_t addr) {
+    if (addr != 0x4015) {
+        return 0x00;
+    }
+
+    catch_up();
+    const uint8_t status = peek_byte(addr);
+    // Reading clears the frame irq, but not the dmc one.
+    if (frame_irq_) {
+        set_frame_irq(false);
+        schedule_frame_irq();
+    }
+    return status;
+}
+
+template <typename Region>
+uint8_t Apu<Region>::peek_byte(uint16_t addr) const {
+    if (addr != 0x4015) {
+        return 0x00;
+    }
+
+    // IF-D NT21, irqs and active channels.
+    uint8_t status = 0;
+    status |= pulse_1_.is_active() ? 0x01u : 0x00u;
+    status |= pulse_2_.is_active() ? 0x02u : 0x00u;
+    status |= triangle_.is_active() ? 0x04u : 0x00u;
+    status |= noise_.is_active() ? 0x08u : 0x00u;
+    status |= dmc_.is_active() ? 0x10u : 0x00u;
+    status |= frame_irq_ ? 0x40u : 0x00u;
+    status |= dmc_.irq() ? 0x80u : 0x00u;
+    return status;
+}
+
+template <typename Region>
+void Apu<Region>::write_byte(uint16_t addr, uint8_t byte) {
+    if (addr < 0x4000 || addr > 0x4017) {
+        return;
+    }
+
+    catch_up();
+
+    if (addr <= 0x4003) {
+        pulse_1_.write(addr, byte);
+    } else if (addr <= 0x4007) {
+        pulse_2_.write(addr, byte);
+    } else if (addr <= 0x400B) {
+        triangle_.write(addr, byte);
+    } else if (addr <= 0x400F) {
+        noise_.write(addr, byte);
+    } else if (addr <= 0x4013) {
+        dmc_.write(addr, byte);
+        update_dmc();
+    } else if (addr == 0x4015) {
+        // ---D NT21, channel enables.
+        pulse_1_.set_enabled(byte & 0x01u);
+        pulse_2_.set_enabled(byte & 0x02u);
+        triangle_.set_enabled(byte & 0x04u);
+        noise_.set_enabled(byte & 0x08u);
+        dmc_.set_enabled(byte & 0x10u);
+        update_dmc();
+    } else if (addr == 0x4017) {
+        // MI-- ----, sequencer mode and irq inhibit. The sequencer really
+        // restarts 3 or 4 cycles after the write.
+        five_step_mode_ = byte & 0x80u;
+        irq_inhibit_ = byte & 0x40u;
+        if (irq_inhibit_) {
+            set_frame_irq(false);
+        }
+        frame_cycle_ = 0;
+        if (five_step_mode_) {
+            clock_quarter_frame();
+            clock_half_frame();
+        }
+        schedule_frame_irq();
+    }
+}
+
+template <typename Region>
+void Apu<Region>::run_until(uint64_t cpu_cycle) {
+    // Runs in spans between the events the channels can't run past.
+    while (cycle_ < cpu_cycle) {
+        const uint32_t next_frame_event = next_frame_counter_event();
+        const auto span = static_cast<uint32_t>(std::min<uint64_t>({
+                cpu_cycle - cycle_,
+                next_frame_event - frame_cycle_,
+                kAudioFrameCycles - audio_cycle_,
+        }));
+
+        run_channels(span);
+
+        frame_cycle_ += span;
+        if (frame_cycle_ == next_frame_event) {
+            clock_frame_counter();
+        }
+        if (audio_cycle_ == kAudioFrameCycles) {
+            end_audio_frame();
+        }
+    }
+}
+
+template <typename Region>
+void Apu<Region>::run_channels(uint32_t cycles) {
+    // The timers only affect the output, so they're left alone while no
+    // one listens.
+    if (streams_.empty()) {
+        // Except for the dmc's, as it decides when samples are read.
+        dmc_.advance(cycles);
+        cycle_ += cycles;
+        audio_cycle_ += cycles;
+        return;
+    }
+
+    for (uint32_t i = 0; i < cycles; ++i) {
+        triangle_.clock_timer();
+        dmc_.clock_timer();
+        noise_.clock_timer();
+        if (cycle_ & 1u) {
+            pulse_1_.clock_timer();
+            pulse_2_.clock_timer();
+        }
+        ++cycle_;
+
+        update_output();
+        ++audio_cycle_;
+    }
+}
+
+template <typename Region>
+void Apu<Region>::catch_up() {
+    if (cpu_clock_) {
+        run_until(cpu_clock_());
+    }
+}
+
+template <typename Region>
+uint32_t Apu<Region>::next_frame_counter_event() const {
+    for (const uint32_t event : kFrameCounterEvents) {
+        if (event > frame_cycle_) {
+            return event;
+        }
+    }
+    return kFrameCounterEvents.back();
+}
+
+// https://www.nesdev.org/wiki/APU_Frame_Counter
+template <typename Region>
+void Apu<Region>::clock_frame_counter() {
+    switch (frame_cycle_) {
+    case kFrameCounterEvents[0]:
+        clock_quarter_frame();
+        break;
+    case kFrameCounterEvents[1]:
+        clock_quarter_frame();
+        clock_half_frame();
+        break;
+    case kFrameCounterEvents[2]:
+        clock_quarter_frame();
+        break;
+    case kFrameCounterEvents[3]:
+        if (!five_step_mode_) {
+            clock_quarter_frame();
+            clock_half_frame();
+            if (!irq_inhibit_) {
+                set_frame_irq(true);
+            }
+        }
+        break;
+    case kFrameCounterEvents[4]:
+        if (!five_step_mode_) {
+            frame_cycle_ = 0;
+        }
+        break;
+    case kFrameCounterEvents[5]:
+        clock_quarter_frame();
+        clock_half_frame();
+        break;
+    case kFrameCounterEvents[6]:
+        frame_cycle_ = 0;
+        break;
+    default:
+        break;
+    }
+}
+
+template <typename Region>
+void Apu<Region>::clock_quarter_frame() {
+    pulse_1_.clock_quarter_frame();
+    pulse_2_.clock_quarter_frame();
+    triangle_.clock_quarter_frame();
+    noise_.clock_quarter_frame();
+}
+
+template <typename Region>
+void Apu<Region>::clock_half_frame() {
+    pulse_1_.clock_half_frame();
+    pulse_2_.clock_half_frame();
+    triangle_.clock_half_frame();
+    noise_.clock_half_frame();
+}
+
+// The cpu is told when the frame irq will be raised, so that the apu doesn't
+// have to run every cycle to raise it in time.
+template <typename Region>
+void Apu<Region>::schedule_frame_irq() {
+    if (frame_irq_) {
+        return;
+    }
+
+    if (five_step_mode_ || irq_inhibit_) {
+        // Releasing cancels anything scheduled.
+        irq_handler_(IRQ_APU_FRAME_COUNTER, false);
+        return;
+    }
+
+    const uint32_t cycles = frame_cycle_ < kFrameIrqCycle
+                                    ? kFrameIrqCycle - frame_cycle_
+                                    : kFourStepLength - frame_cycle_ +
+                                              kFrameIrqCycle;
+    irq_scheduler_(IRQ_APU_FRAME_COUNTER, cycle_ + cycles);
+}
+
+template <typename Region>
+void Apu<Region>::set_frame_irq(bool asserted) {
+    if (asserted != frame_irq_) {
+        frame_irq_ = asserted;
+        irq_handler_(IRQ_APU_FRAME_COUNTER, asserted);
+    }
+}
+
+// The cpu is told when the dmc will need its next sample byte, so that it
+// can stall for the dma then without checking for it every cycle.
+template <typename Region>
+void Apu<Region>::update_dmc() {
+    if (dmc_.irq() != dmc_irq_) {
+        dmc_irq_ = dmc_.irq();
+        irq_handler_(IRQ_APU_DMC, dmc_irq_);
+    }
+
+    const std::optional<uint32_t> cycles = dmc_.cycles_until_sample_needed();
+    dma_scheduler_(cycles ? std::optional<uint64_t>(cycle_ + *cycles)
+                          : std::nullopt);
+}
+
+template <typename Region>
+void Apu<Region>::dma(uint64_t cpu_cycle) {
+    run_until(cpu_cycle);
+    if (dmc_.needs_sample()) {
+        dmc_.load_sample(dma_reader_(dmc_.sample_address()));
+    }
+    update_dmc();
+}
 
-uint8_t Apu::read_byte(uint16_t addr) {
-    addr_ = addr;
-    return 0x00;
+template <typename Region>
+std::array<int32_t, Apu<Region>::kChannelCount> Apu<Region>::levels() const {
+    return {
+            pulse_1_.output(),
+            pulse_2_.output(),
+            triangle_.output(),
+            noise_.output(),
+            dmc_.output(),
+    };
 }
-void Apu::write_byte(uint16_t addr, uint8_t byte) {
-    addr_ = addr;
-    byte_ = byte;
+
+template <typename Region>
+int32_t Apu<Region>::mix(
+        const std::array<int32_t, kChannelCount> &channel_levels) {
+    const auto &l = channel_levels;
+    const auto pulse = static_cast<std::size_t>(l[kPulse1] + l[kPulse2]);
+    const auto tnd = static_cast<std::size_t>(
+            3 * l[kTriangle] + 2 * l[kNoise] + l[kDmc]);
+    return kPulseTable[pulse] + kTndTable[tnd];
 }
 
-void Apu::execute() {
-    // Dummy calls to sample handlers
-    if (sample_handler_) {
-        sample_handler_(0x01);
+template <typename Region>
+int32_t Apu<Region>::amplitude(std::optional<std::size_t> channel,
+        const std::array<int32_t, kChannelCount> &channel_levels) {
+    if (!channel) {
+        return mix(channel_levels);
     }
-    if (sample_handler_pulse_1_) {
-        sample_handler_pulse_1_(0x02);
+    return channel_levels[*channel] * kChannelScale[*channel];
+}
+
+template <typename Region>
+void Apu<Region>::update_output() {
+    if (streams_.empty()) {
+        return;
     }
-    if (sample_handler_pulse_2_) {
-        sample_handler_pulse_2_(0x03);
+
+    const std::array<int32_t, kChannelCount> channel_levels = levels();
+    for (SampleStream *const stream : streams_) {
+        const int32_t next = amplitude(stream->channel, channel_levels);
+        if (next != stream->amplitude) {
+            stream->buffer.add_delta(audio_cycle_, next - stream->amplitude);
+            stream->amplitude = next;
+        }
     }
-    if (sample_handler_triangle_) {
-        sample_handler_triangle_(0x04);
+}
+
+template <typename Region>
+void Apu<Region>::end_audio_frame() {
+    const TraceScope trace("Apu::end_audio_frame");
+
+    for (SampleStream *const stream : streams_) {
+        stream->buffer.end_frame(audio_cycle_);
+        samples_.resize(stream->buffer.samples_available());
+        samples_.resize(stream->buffer.read_samples(samples_));
+        stream->sink(samples_);
+        stream->buffer.set_rates(Region::kCpuClockRate, sample_rate_);
     }
-    if (sample_handler_noise_) {
-        sample_handler_noise_(0x05);
+
+    audio_cycle_ = 0;
+}
+
+template <typename Region>
+void Apu<Region>::set_sample_rate(uint32_t sample_rate) {
+    // Applied at the end of the audio frame as deltas already added are
+    // positioned using the old rate.
+    sample_rate_ = sample_rate;
+}
+
+template <typename Region>
+void Apu<Region>::set_resampling_quality(ResamplingQuality quality) {
+    switch (quality) {
+    case ResamplingQuality::Low:
+        quality_ = BlipBuffer::Quality::Low;
+        break;
+    case ResamplingQuality::Medium:
+        quality_ = BlipBuffer::Quality::Medium;
+        break;
+    case ResamplingQuality::High:
+        quality_ = BlipBuffer::Quality::High;
+        break;
     }
-    if (sample_handler_pcm_) {
-        sample_handler_pcm_(0x06);
+
+    for (SampleStream *const stream : streams_) {
+        stream->buffer.set_quality(quality_);
     }
 }
 
-void Apu::set_sample_handler(
-        const std::function<void(int8_t)> &sample_handler) {
-    sample_handler_ = sample_handler;
+template <typename Region>
+void Apu<Region>::set_cpu_clock(const std::function<uint64_t()> &cpu_clock) {
+    cpu_clock_ = cpu_clock;
+}
+
+template <typename Region>
+void Apu<Region>::set_irq_handler(
+        const std::function<void(uint8_t, bool)> &irq_handler) {
+    irq_handler_ = irq_handler;
 }
 
-void Apu::set_sample_handler_pulse_1(
-        const std::function<void(int8_t)> &sample_handler) {
-    sample_handler_pulse_1_ = sample_handler;
+template <typename Region>
+void Apu<Region>::set_irq_scheduler(
+        const std::function<void(uint8_t, uint64_t)> &irq_scheduler) {
+    irq_scheduler_ = irq_scheduler;
+    schedule_frame_irq();
 }
 
-void Apu::set_sample_handler_pulse_2(
-        const std::function<void(int8_t)> &sample_handler) {
-    sample_handler_pulse_2_ = sample_handler;
+template <typename Region>
+void Apu<Region>::set_dma_reader(
+        const std::function<uint8_t(uint16_t)> &dma_reader) {
+    dma_reader_ = dma_reader;
 }
 
-void Apu::set_sample_handler_triangle(
-        const std::function<void(int8_t)> &sample_handler) {
-    sample_handler_triangle_ = sample_handler;
+template <typename Region>
+void Apu<Region>::set_dma_scheduler(
+        const std::function<void(std::optional<uint64_t>)> &dma_scheduler) {
+    dma_scheduler_ = dma_scheduler;
+    update_dmc();
 }
 
-void Apu::set_sample_handler_noise(
-        const std::function<void(int8_t)> &sample_handler) {
-    sample_handler_noise_ = sample_handler;
+template <typename Region>
+void Apu<Region>::set_sample_sink(const SampleSink &sink) {
+    set_stream(mixed_, std::nullopt, sink);
 }
 
-void Apu::set_sample_handler_pcm(
-        const std::function<void(int8_t)> &sample_handler) {
-    sample_handler_pcm_ = sample_handler;
+template <typename Region>
+void Apu<Region>::set_channel_sample_sink(Channel channel,
+        const SampleSink &sink) {
+    const auto index = static_cast<std::size_t>(channel);
+    set_stream(channels_.at(index), index, sink);
 }
 
-} // namespace n_e_s::core
\ No newline at end of file
+template <typename Region>
+void Apu<Region>::set_stream(std::unique_ptr<SampleStream> &stream,
+        std::optional<std::size_t> channel,
+        const SampleSink &sink) {
+    if (!sink) {
+        stream.reset();
+    } else if (stream) {
+        stream->sink = sink;
+    } else {
+        // Channels don't necessarily rest at 0, the triangle e.g. doesn't,
+        // so start from wherever they are to not begin with a click.
+        stream = std::make_unique<SampleStream>(SampleStream{
+                .sink = sink,
+                .buffer = BlipBuffer(
+                        Region::kCpuClockRate, sample_rate_, quality_),
+                .amplitude = amplitude(channel, levels()),
+                .channel = channel,
+        });
+    }
+
+    streams_.clear();
+    if (mixed_) {
+        streams_.push_back(mixed_.get());
+    }
+    for (const std::unique_ptr<SampleStream> &c : channels_) {
+        if (c) {
+            streams_.push_back(c.get());
+        }
+    }
+}
+
+template class Apu<Ntsc>;
+template class Apu<Pal>;
+template class Apu<Dendy>;
+
+} // namespace n_e_s::core
@@ -1,43 +1,137 @@
 #pragma once
 
 #include "nes/core/iapu.h"
+#include "nes/core/region.h"
+
+#include "apu/blip_buffer.h"
+#include "apu/dmc.h"
+#include "apu/noise.h"
+#include "apu/pulse.h"
+#include "apu/triangle.h"
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
 
 namespace n_e_s::core {
 
+template <typename Region>
 class Apu final : public IApu {
 public:
-    explicit Apu() = default;
+    Apu();
 
     uint8_t read_byte(uint16_t addr) override;
     void write_byte(uint16_t addr, uint8_t byte) override;
+    uint8_t peek_byte(uint16_t addr) const override;
 
-    void execute() override;
+    void run_until(uint64_t cpu_cycle) override;
+    void set_cpu_clock(const std::function<uint64_t()> &cpu_clock) override;
 
-    void set_sample_handler(
-            const std::function<void(int8_t)> &sample_handler) override;
+    void set_sample_rate(uint32_t sample_rate) override;
+    void set_resampling_quality(ResamplingQuality quality) override;
+    void set_irq_handler(
+            const std::function<void(uint8_t, bool)> &irq_handler) override;
+    void set_irq_scheduler(const std::function<void(uint8_t, uint64_t)>
+                    &irq_scheduler) override;
+    void set_dma_reader(
+            const std::function<uint8_t(uint16_t)> &dma_reader) override;
+    void set_dma_scheduler(const std::function<void(std::optional<uint64_t>)>
+                    &dma_scheduler) override;
+    void dma(uint64_t cpu_cycle) override;
 
-    void set_sample_handler_pulse_1(
-            const std::function<void(int8_t)> &sample_handler) override;
-    void set_sample_handler_pulse_2(
-            const std::function<void(int8_t)> &sample_handler) override;
-    void set_sample_handler_triangle(
-            const std::function<void(int8_t)> &sample_handler) override;
-    void set_sample_handler_noise(
-            const std::function<void(int8_t)> &sample_handler) override;
-    void set_sample_handler_pcm(
-            const std::function<void(int8_t)> &sample_handler) override;
+    void set_sample_sink(const SampleSink &sink) override;
+    void set_channel_sample_sink(Channel channel,
+            const SampleSink &sink) override;
 
 private:
-    std::function<void(int8_t)> sample_handler_{[](int8_t) {}};
-    std::function<void(int8_t)> sample_handler_pulse_1_{[](int8_t) {}};
-    std::function<void(int8_t)> sample_handler_pulse_2_{[](int8_t) {}};
-    std::function<void(int8_t)> sample_handler_triangle_{[](int8_t) {}};
-    std::function<void(int8_t)> sample_handler_noise_{[](int8_t) {}};
-    std::function<void(int8_t)> sample_handler_pcm_{[](int8_t) {}};
-
-    // Dummys for stub
-    uint16_t addr_{};
-    uint8_t byte_{};
+    // Indices into the channel levels, in the order of Channel.
+    enum : std::size_t {
+        kPulse1,
+        kPulse2,
+        kTriangle,
+        kNoise,
+        kDmc,
+        kChannelCount,
+    };
+
+    // The cycles the frame counter does something at, see
+    // clock_frame_counter.
+    static constexpr std::array<uint32_t, 7> kFrameCounterEvents{
+            Region::kFrameCounterEvents};
+    static constexpr uint32_t kFrameIrqCycle{kFrameCounterEvents[3]};
+    static constexpr uint32_t kFourStepLength{kFrameCounterEvents[4]};
+
+    // An output someone listens to. Mixed if channel is unset.
+    struct SampleStream {
+        SampleSink sink;
+        BlipBuffer buffer;
+        int32_t amplitude{};
+        std::optional<std::size_t> channel;
+    };
+
+    void catch_up();
+    void run_channels(uint32_t cycles);
+    [[nodiscard]] uint32_t next_frame_counter_event() const;
+    void clock_frame_counter();
+    void clock_quarter_frame();
+    void clock_half_frame();
+    void schedule_frame_irq();
+    void set_frame_irq(bool asserted);
+    void update_dmc();
+
+    [[nodiscard]] std::array<int32_t, kChannelCount> levels() const;
+    [[nodiscard]] static int32_t mix(
+            const std::array<int32_t, kChannelCount> &channel_levels);
+    void update_output();
+    void end_audio_frame();
+    void set_stream(std::unique_ptr<SampleStream> &stream,
+            std::optional<std::size_t> channel,
+            const SampleSink &sink);
+    [[nodiscard]] static int32_t amplitude(std::optional<std::size_t> channel,
+            const std::array<int32_t, kChannelCount> &channel_levels);
+
+    Pulse pulse_1_{true};
+    Pulse pulse_2_{false};
+    Triangle triangle_;
+    Noise<Region> noise_;
+    Dmc<Region> dmc_;
+
+    // Frame counter
+    bool five_step_mode_{false};
+    bool irq_inhibit_{false};
+    bool frame_irq_{false};
+    uint32_t frame_cycle_{0};
+
+    // The dmc irq as last told to the cpu.
+    bool dmc_irq_{false};
+
+    // Cpu cycles run so far.
+    uint64_t cycle_{0};
+    std::function<uint64_t()> cpu_clock_;
+
+    std::function<void(uint8_t, bool)> irq_handler_{[](uint8_t, bool) {}};
+    std::function<void(uint8_t, uint64_t)> irq_scheduler_{
+            [](uint8_t, uint64_t) {}};
+    std::function<uint8_t(uint16_t)> dma_reader_{
+            [](uint16_t) -> uint8_t { return 0; }};
+    std::function<void(std::optional<uint64_t>)> dma_scheduler_{
+            [](std::optional<uint64_t>) {}};
+
+    uint32_t sample_rate_{44100};
+    BlipBuffer::Quality quality_{BlipBuffer::Quality::Medium};
+    // Cpu cycles since the current audio frame started.
+    uint32_t audio_cycle_{0};
+
+    // Streams only exist while someone listens to them.
+    std::unique_ptr<SampleStream> mixed_;
+    std::array<std::unique_ptr<SampleStream>, kChannelCount> channels_{};
+    // The streams that exist, so that nothing is done without listeners.
+    std::vector<SampleStream *> streams_;
+
+    std::vector<int16_t> samples_;
 };
 
-} // namespace n_e_s::core
\ No newline at end of file
+} // namespace n_e_s::core
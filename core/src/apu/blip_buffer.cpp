@@ -0,0 +1,138 @@
+#include "apu/blip_buffer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numbers>
+
+namespace n_e_s::core {
+
+namespace {
+
+// Blackman windowed sincs, one per fraction of a sample a step can start
+// at. Each is delayed by width / 2 - 1 samples so that it's causal.
+std::vector<int32_t> make_kernels(std::size_t width,
+        std::size_t phases,
+        int delta_bits) {
+    // Cut off below nyquist to leave room for the window's roll-off, which
+    // is steeper the wider the kernel is.
+    const double cutoff = 1.0 - 1.6 / static_cast<double>(width);
+    const double half_width = static_cast<double>(width) / 2.0;
+
+    std::vector<int32_t> kernels(width * phases);
+    std::vector<double> taps(width);
+    for (std::size_t phase = 0; phase < phases; ++phase) {
+        const double fraction =
+                static_cast<double>(phase) / static_cast<double>(phases);
+
+        double sum = 0.0;
+        for (std::size_t i = 0; i < width; ++i) {
+            const double x =
+                    static_cast<double>(i) - (half_width - 1.0) - fraction;
+            const double t = std::numbers::pi * cutoff * x;
+            const double sinc = x == 0.0 ? 1.0 : std::sin(t) / t;
+            const double w = std::numbers::pi * x / half_width;
+            const double window =
+                    0.42 + 0.5 * std::cos(w) + 0.08 * std::cos(2.0 * w);
+            taps[i] = sinc * window;
+            sum += taps[i];
+        }
+
+        // Scale to integers and put the rounding error in the middle so
+        // that every kernel sums to exactly 1 << delta_bits.
+        int32_t *const kernel = kernels.data() + phase * width;
+        int32_t total = 0;
+        for (std::size_t i = 0; i < width; ++i) {
+            kernel[i] = static_cast<int32_t>(
+                    std::lround(taps[i] / sum * (1 << delta_bits)));
+            total += kernel[i];
+        }
+        kernel[width / 2 - 1] += (1 << delta_bits) - total;
+    }
+    return kernels;
+}
+
+} // namespace
+
+const std::vector<int32_t> &BlipBuffer::kernels(std::size_t width) {
+    static const std::vector<int32_t> k8{make_kernels(8, kPhases, kDeltaBits)};
+    static const std::vector<int32_t> k16{
+            make_kernels(16, kPhases, kDeltaBits)};
+    static const std::vector<int32_t> k32{
+            make_kernels(32, kPhases, kDeltaBits)};
+    return width == 8 ? k8 : width == 16 ? k16 : k32;
+}
+
+BlipBuffer::BlipBuffer(uint32_t clock_rate,
+        uint32_t sample_rate,
+        Quality quality) {
+    set_rates(clock_rate, sample_rate);
+    set_quality(quality);
+}
+
+void BlipBuffer::set_rates(uint32_t clock_rate, uint32_t sample_rate) {
+    factor_ = (uint64_t{sample_rate} << kFracBits) / clock_rate;
+}
+
+void BlipBuffer::set_quality(Quality quality) {
+    quality_ = quality;
+    switch (quality_) {
+    case Quality::Low:
+        kernels_ = kernels(8).data();
+        break;
+    case Quality::Medium:
+        kernels_ = kernels(16).data();
+        break;
+    case Quality::High:
+        kernels_ = kernels(32).data();
+        break;
+    }
+}
+
+void BlipBuffer::end_frame(uint32_t duration) {
+    offset_ += duration * factor_;
+    if (samples_available() + kMaxWidth > buffer_.size()) {
+        buffer_.resize(samples_available() + kMaxWidth);
+    }
+}
+
+std::size_t BlipBuffer::read_samples(std::span<int16_t> dst) {
+    const std::size_t available = samples_available();
+    const std::size_t count = std::min(dst.size(), available);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        integrator_ += buffer_[i];
+        const int64_t sample = integrator_ >> kDeltaBits;
+
+        // A one pole high-pass at about 15 Hz at 44.1 kHz, like the
+        // capacitors on the console's output.
+        dc_ += ((sample << 16) - dc_) >> 9;
+        const int64_t filtered = sample - (dc_ >> 16);
+
+        dst[i] = static_cast<int16_t>(std::clamp<int64_t>(filtered,
+                std::numeric_limits<int16_t>::min(),
+                std::numeric_limits<int16_t>::max()));
+    }
+
+    // Move what's left, including the tails of the last steps, to the
+    // front.
+    const std::size_t live = available + kMaxWidth;
+    std::copy(buffer_.begin() + static_cast<std::ptrdiff_t>(count),
+            buffer_.begin() + static_cast<std::ptrdiff_t>(live),
+            buffer_.begin());
+    std::fill(buffer_.begin() + static_cast<std::ptrdiff_t>(live - count),
+            buffer_.begin() + static_cast<std::ptrdiff_t>(live),
+            0);
+    offset_ -= uint64_t{count} << kFracBits;
+
+    return count;
+}
+
+void BlipBuffer::clear() {
+    offset_ = 0;
+    integrator_ = 0;
+    dc_ = 0;
+    buffer_.assign(buffer_.size(), 0);
+}
+
+} // namespace n_e_s::core
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace n_e_s::core {
+
+// Turns amplitude changes at clock times into samples at the output rate.
+// Every change adds a band-limited step, a windowed sinc picked from a
+// polyphase table, so synthesis costs something per change instead of per
+// clock, and fast changes don't alias. The steps are summed up into
+// samples a whole frame at a time when they're read.
+class BlipBuffer {
+public:
+    // Wider kernels cost more per change but keep more of the treble and
+    // let less alias through.
+    enum class Quality {
+        Low, // 8 taps
+        Medium, // 16 taps
+        High, // 32 taps
+    };
+
+    BlipBuffer(uint32_t clock_rate,
+            uint32_t sample_rate,
+            Quality quality = Quality::Medium);
+
+    // These may be changed between frames without disturbing the output.
+    void set_rates(uint32_t clock_rate, uint32_t sample_rate);
+    void set_quality(Quality quality);
+
+    // Adds a change in amplitude clock_time clocks after the start of the
+    // current frame.
+    void add_delta(uint32_t clock_time, int32_t delta) {
+        const uint64_t position = offset_ + clock_time * factor_;
+        const std::size_t index = position >> kFracBits;
+        const std::size_t phase =
+                (position >> (kFracBits - kPhaseBits)) & (kPhases - 1);
+        if (index + kMaxWidth > buffer_.size()) {
+            buffer_.resize(index + kMaxWidth);
+        }
+
+        int32_t *const out = buffer_.data() + index;
+        switch (quality_) {
+        case Quality::Low:
+            add_step<8>(out, kernels_, phase, delta);
+            break;
+        case Quality::Medium:
+            add_step<16>(out, kernels_, phase, delta);
+            break;
+        case Quality::High:
+            add_step<32>(out, kernels_, phase, delta);
+            break;
+        }
+    }
+
+    // Ends the current frame after duration clocks, making the samples in
+    // it readable. Following deltas are relative to the end of this frame.
+    void end_frame(uint32_t duration);
+
+    [[nodiscard]] std::size_t samples_available() const {
+        return offset_ >> kFracBits;
+    }
+
+    // Reads and removes up to dst.size() samples. Returns the number read.
+    std::size_t read_samples(std::span<int16_t> dst);
+
+    void clear();
+
+private:
+    static constexpr int kFracBits{32};
+    static constexpr int kPhaseBits{5};
+    static constexpr std::size_t kPhases{1u << kPhaseBits};
+    static constexpr std::size_t kMaxWidth{32};
+    // The kernels sum to 1 << kDeltaBits.
+    static constexpr int kDeltaBits{15};
+
+    // kPhases kernels of width taps each, one after the other.
+    static const std::vector<int32_t> &kernels(std::size_t width);
+
+    // The width is known at compile time so that the loop is unrolled and
+    // vectorised.
+    template <std::size_t Width>
+    static void add_step(int32_t *out,
+            const int32_t *table,
+            std::size_t phase,
+            int32_t delta) {
+        const int32_t *const kernel = table + phase * Width;
+        for (std::size_t i = 0; i < Width; ++i) {
+            out[i] += kernel[i] * delta;
+        }
+    }
+
+    Quality quality_{};
+    const int32_t *kernels_{};
+
+    // Output samples per clock, with kFracBits of fraction.
+    uint64_t factor_{};
+    // The start of the current frame in samples, with kFracBits of fraction.
+    uint64_t offset_{};
+
+    // Room is always kept for the widest kernel so that the quality can be
+    // changed without cutting off the tails of earlier steps.
+    std::vector<int32_t> buffer_;
+    int64_t integrator_{};
+    int64_t dc_{}; // Tracks the dc offset to filter it out.
+};
+
+} // namespace n_e_s::core
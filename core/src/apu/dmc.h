@@ -0,0 +1,163 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+
+namespace n_e_s::core {
+
+// https://www.nesdev.org/wiki/APU_DMC
+//
+// The sample bytes are read from cpu memory by a dma that the apu schedules
+// ahead of time, see cycles_until_sample_needed.
+template <typename Region>
+class Dmc {
+public:
+    void write(uint16_t reg, uint8_t byte) {
+        switch (reg & 0x03u) {
+        case 0: // IL-- RRRR
+            irq_enabled_ = byte & 0x80u;
+            loop_ = byte & 0x40u;
+            period_ = kPeriods[byte & 0x0Fu];
+            if (!irq_enabled_) {
+                irq_ = false;
+            }
+            break;
+        case 1: // -DDD DDDD
+            level_ = byte & 0x7Fu;
+            break;
+        case 2: // AAAA AAAA, $C000 + A * 64
+            sample_address_ = static_cast<uint16_t>(0xC000u + byte * 64u);
+            break;
+        case 3: // LLLL LLLL, L * 16 + 1 bytes
+            sample_length_ = static_cast<uint16_t>(byte * 16u + 1u);
+            break;
+        }
+    }
+
+    // Writing to $4015 clears the irq whether enabling or not.
+    void set_enabled(bool enabled) {
+        irq_ = false;
+        if (!enabled) {
+            bytes_remaining_ = 0;
+        } else if (bytes_remaining_ == 0) {
+            restart();
+        }
+    }
+
+    [[nodiscard]] bool is_active() const {
+        return bytes_remaining_ > 0;
+    }
+
+    [[nodiscard]] bool irq() const {
+        return irq_;
+    }
+
+    [[nodiscard]] bool needs_sample() const {
+        return !buffer_ && bytes_remaining_ > 0;
+    }
+
+    [[nodiscard]] uint16_t sample_address() const {
+        return address_;
+    }
+
+    void load_sample(uint8_t byte) {
+        buffer_ = byte;
+        address_ = address_ == 0xFFFFu ? uint16_t{0x8000u}
+                                       : static_cast<uint16_t>(address_ + 1u);
+        if (--bytes_remaining_ == 0) {
+            if (loop_) {
+                restart();
+            } else if (irq_enabled_) {
+                irq_ = true;
+            }
+        }
+    }
+
+    // The cpu cycles until the sample buffer is emptied and a new byte has
+    // to be read, or nullopt if the sample has ended.
+    [[nodiscard]] std::optional<uint32_t> cycles_until_sample_needed() const {
+        if (needs_sample()) {
+            return 0;
+        }
+        if (bytes_remaining_ == 0) {
+            return std::nullopt;
+        }
+        // The buffer is emptied into the shift register as the last bit of
+        // the current byte has been output.
+        return timer_ + 1u + (bits_remaining_ - 1u) * uint32_t{period_};
+    }
+
+    // Clocked every cpu cycle, the periods are in cpu cycles.
+    void clock_timer() {
+        if (timer_ == 0) {
+            timer_ = period_ - 1u;
+            clock_output();
+        } else {
+            --timer_;
+        }
+    }
+
+    // Runs the timer for a number of cpu cycles at once.
+    void advance(uint32_t cycles) {
+        while (cycles > timer_) {
+            cycles -= timer_ + 1u;
+            timer_ = period_ - 1u;
+            clock_output();
+        }
+        timer_ = static_cast<uint16_t>(timer_ - cycles);
+    }
+
+    [[nodiscard]] uint8_t output() const {
+        return level_;
+    }
+
+private:
+    static constexpr std::array<uint16_t, 16> kPeriods{Region::kDmcPeriods};
+
+    void restart() {
+        address_ = sample_address_;
+        bytes_remaining_ = sample_length_;
+    }
+
+    void clock_output() {
+        if (!silent_) {
+            if (shift_ & 0x01u) {
+                if (level_ <= 125) {
+                    level_ = static_cast<uint8_t>(level_ + 2u);
+                }
+            } else if (level_ >= 2) {
+                level_ = static_cast<uint8_t>(level_ - 2u);
+            }
+        }
+        shift_ >>= 1u;
+
+        if (--bits_remaining_ == 0) {
+            bits_remaining_ = 8;
+            silent_ = !buffer_;
+            shift_ = buffer_.value_or(0);
+            buffer_.reset();
+        }
+    }
+
+    bool irq_enabled_{false};
+    bool irq_{false};
+    bool loop_{false};
+    uint16_t period_{kPeriods[0]};
+    uint16_t timer_{0};
+    uint8_t level_{0};
+
+    // Reader
+    uint16_t sample_address_{0xC000};
+    uint16_t sample_length_{1};
+    uint16_t address_{0xC000};
+    uint16_t bytes_remaining_{0};
+    std::optional<uint8_t> buffer_;
+
+    // Output unit
+    uint8_t shift_{0};
+    uint8_t bits_remaining_{8};
+    bool silent_{true};
+};
+
+} // namespace n_e_s::core
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+
+namespace n_e_s::core {
+
+// A constant volume or a sawtooth decaying from 15, clocked by quarter
+// frames. https://www.nesdev.org/wiki/APU_Envelope
+class Envelope {
+public:
+    // --LC VVVV, loop, constant volume and volume or decay period.
+    void write_control(uint8_t byte) {
+        loop_ = byte & 0x20u;
+        constant_volume_ = byte & 0x10u;
+        volume_ = byte & 0x0Fu;
+    }
+
+    void restart() {
+        start_ = true;
+    }
+
+    void clock() {
+        if (start_) {
+            start_ = false;
+            decay_ = 15;
+            divider_ = volume_;
+        } else if (divider_ == 0) {
+            divider_ = volume_;
+            if (decay_ > 0) {
+                --decay_;
+            } else if (loop_) {
+                decay_ = 15;
+            }
+        } else {
+            --divider_;
+        }
+    }
+
+    [[nodiscard]] uint8_t output() const {
+        return constant_volume_ ? volume_ : decay_;
+    }
+
+private:
+    bool loop_{false};
+    bool constant_volume_{false};
+    uint8_t volume_{0};
+
+    bool start_{false};
+    uint8_t divider_{0};
+    uint8_t decay_{0};
+};
+
+} // namespace n_e_s::core
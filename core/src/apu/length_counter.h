@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace n_e_s::core {
+
+// Silences a channel once it has counted down, clocked by half frames.
+// https://www.nesdev.org/wiki/APU_Length_Counter
+class LengthCounter {
+public:
+    void set_enabled(bool enabled) {
+        enabled_ = enabled;
+        if (!enabled_) {
+            count_ = 0;
+        }
+    }
+
+    void set_halted(bool halted) {
+        halted_ = halted;
+    }
+
+    // Loads the count from the upper 5 bits of the channel's last register.
+    void load(uint8_t byte) {
+        if (enabled_) {
+            count_ = kLengths[byte >> 3u];
+        }
+    }
+
+    void clock() {
+        if (!halted_ && count_ > 0) {
+            --count_;
+        }
+    }
+
+    [[nodiscard]] bool is_active() const {
+        return count_ > 0;
+    }
+
+private:
+    static constexpr std::array<uint8_t, 32> kLengths{10, 254, 20, 2, 40, 4,
+            80, 6, 160, 8, 60, 10, 14, 12, 26, 14, 12, 16, 24, 18, 48, 20, 96,
+            22, 192, 24, 72, 26, 16, 28, 32, 30};
+
+    bool enabled_{false};
+    bool halted_{false};
+    uint8_t count_{0};
+};
+
+} // namespace n_e_s::core
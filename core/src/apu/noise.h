@@ -0,0 +1,82 @@
+#pragma once
+
+#include "apu/envelope.h"
+#include "apu/length_counter.h"
+
+#include <array>
+#include <cstdint>
+
+namespace n_e_s::core {
+
+// https://www.nesdev.org/wiki/APU_Noise
+template <typename Region>
+class Noise {
+public:
+    void write(uint16_t reg, uint8_t byte) {
+        switch (reg & 0x03u) {
+        case 0: // --LC VVVV
+            length_.set_halted(byte & 0x20u);
+            envelope_.write_control(byte);
+            break;
+        case 1: // Unused
+            break;
+        case 2: // M--- PPPP
+            short_mode_ = byte & 0x80u;
+            period_ = kPeriods[byte & 0x0Fu];
+            break;
+        case 3: // llll l---
+            length_.load(byte);
+            envelope_.restart();
+            break;
+        }
+    }
+
+    void set_enabled(bool enabled) {
+        length_.set_enabled(enabled);
+    }
+
+    // Clocked every cpu cycle, the periods are in cpu cycles.
+    void clock_timer() {
+        if (timer_ == 0) {
+            timer_ = period_ - 1u;
+            const unsigned tap = short_mode_ ? 6u : 1u;
+            const auto feedback =
+                    static_cast<uint16_t>((shift_ ^ (shift_ >> tap)) & 0x01u);
+            shift_ = static_cast<uint16_t>((shift_ >> 1u) | (feedback << 14u));
+        } else {
+            --timer_;
+        }
+    }
+
+    void clock_quarter_frame() {
+        envelope_.clock();
+    }
+
+    void clock_half_frame() {
+        length_.clock();
+    }
+
+    [[nodiscard]] bool is_active() const {
+        return length_.is_active();
+    }
+
+    [[nodiscard]] uint8_t output() const {
+        if (!length_.is_active() || (shift_ & 0x01u)) {
+            return 0;
+        }
+        return envelope_.output();
+    }
+
+private:
+    static constexpr std::array<uint16_t, 16> kPeriods{Region::kNoisePeriods};
+
+    Envelope envelope_;
+    LengthCounter length_;
+
+    bool short_mode_{false};
+    uint16_t period_{kPeriods[0]};
+    uint16_t timer_{0};
+    uint16_t shift_{1};
+};
+
+} // namespace n_e_s::core
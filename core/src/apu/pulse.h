@@ -0,0 +1,130 @@
+#pragma once
+
+#include "apu/envelope.h"
+#include "apu/length_counter.h"
+
+#include <array>
+#include <cstdint>
+
+namespace n_e_s::core {
+
+// https://www.nesdev.org/wiki/APU_Pulse
+class Pulse {
+public:
+    // Pulse 1 negates its sweep using ones' complement, pulse 2 using two's
+    // complement.
+    explicit Pulse(bool ones_complement_sweep)
+            : sweep_negate_extra_(ones_complement_sweep ? 1 : 0) {}
+
+    void write(uint16_t reg, uint8_t byte) {
+        switch (reg & 0x03u) {
+        case 0: // DDLC VVVV
+            duty_ = byte >> 6u;
+            length_.set_halted(byte & 0x20u);
+            envelope_.write_control(byte);
+            break;
+        case 1: // EPPP NSSS
+            sweep_enabled_ = byte & 0x80u;
+            sweep_period_ = (byte >> 4u) & 0x07u;
+            sweep_negate_ = byte & 0x08u;
+            sweep_shift_ = byte & 0x07u;
+            sweep_reload_ = true;
+            break;
+        case 2: // LLLL LLLL
+            period_ = static_cast<uint16_t>((period_ & 0x0700u) | byte);
+            break;
+        case 3: // llll lHHH
+            period_ = static_cast<uint16_t>(
+                    (period_ & 0x00FFu) | ((byte & 0x07u) << 8u));
+            length_.load(byte);
+            envelope_.restart();
+            step_ = 0;
+            break;
+        }
+    }
+
+    void set_enabled(bool enabled) {
+        length_.set_enabled(enabled);
+    }
+
+    // Clocked every other cpu cycle.
+    void clock_timer() {
+        if (timer_ == 0) {
+            timer_ = period_;
+            step_ = (step_ - 1u) & 0x07u;
+        } else {
+            --timer_;
+        }
+    }
+
+    void clock_quarter_frame() {
+        envelope_.clock();
+    }
+
+    void clock_half_frame() {
+        length_.clock();
+
+        if (sweep_divider_ == 0 && sweep_enabled_ && sweep_shift_ > 0 &&
+                !is_muted()) {
+            period_ = target_period();
+        }
+        if (sweep_divider_ == 0 || sweep_reload_) {
+            sweep_divider_ = sweep_period_;
+            sweep_reload_ = false;
+        } else {
+            --sweep_divider_;
+        }
+    }
+
+    [[nodiscard]] bool is_active() const {
+        return length_.is_active();
+    }
+
+    [[nodiscard]] uint8_t output() const {
+        if (!length_.is_active() || is_muted() || !kDuty[duty_][step_]) {
+            return 0;
+        }
+        return envelope_.output();
+    }
+
+private:
+    static constexpr std::array<std::array<bool, 8>, 4> kDuty{{
+            {0, 0, 0, 0, 0, 0, 0, 1},
+            {0, 0, 0, 0, 0, 0, 1, 1},
+            {0, 0, 0, 0, 1, 1, 1, 1},
+            {1, 1, 1, 1, 1, 1, 0, 0},
+    }};
+
+    [[nodiscard]] uint16_t target_period() const {
+        const uint16_t change = period_ >> sweep_shift_;
+        if (sweep_negate_) {
+            const int target = period_ - change - sweep_negate_extra_;
+            return target < 0 ? 0 : static_cast<uint16_t>(target);
+        }
+        return static_cast<uint16_t>(period_ + change);
+    }
+
+    // The sweep unit mutes the channel even when it's disabled.
+    [[nodiscard]] bool is_muted() const {
+        return period_ < 8 || target_period() > 0x07FFu;
+    }
+
+    const int sweep_negate_extra_;
+
+    Envelope envelope_;
+    LengthCounter length_;
+
+    uint8_t duty_{0};
+    uint8_t step_{0};
+    uint16_t period_{0};
+    uint16_t timer_{0};
+
+    bool sweep_enabled_{false};
+    bool sweep_negate_{false};
+    bool sweep_reload_{false};
+    uint8_t sweep_period_{0};
+    uint8_t sweep_shift_{0};
+    uint8_t sweep_divider_{0};
+};
+
+} // namespace n_e_s::core
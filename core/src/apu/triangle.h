@@ -0,0 +1,89 @@
+#pragma once
+
+#include "apu/length_counter.h"
+
+#include <cstdint>
+
+namespace n_e_s::core {
+
+// https://www.nesdev.org/wiki/APU_Triangle
+class Triangle {
+public:
+    void write(uint16_t reg, uint8_t byte) {
+        switch (reg & 0x03u) {
+        case 0: // CRRR RRRR
+            control_ = byte & 0x80u;
+            length_.set_halted(control_);
+            linear_reload_value_ = byte & 0x7Fu;
+            break;
+        case 1: // Unused
+            break;
+        case 2: // LLLL LLLL
+            period_ = static_cast<uint16_t>((period_ & 0x0700u) | byte);
+            break;
+        case 3: // llll lHHH
+            period_ = static_cast<uint16_t>(
+                    (period_ & 0x00FFu) | ((byte & 0x07u) << 8u));
+            length_.load(byte);
+            linear_reload_ = true;
+            break;
+        }
+    }
+
+    void set_enabled(bool enabled) {
+        length_.set_enabled(enabled);
+    }
+
+    // Clocked every cpu cycle.
+    void clock_timer() {
+        if (timer_ == 0) {
+            timer_ = period_;
+            // Ultrasonic periods are inaudible and would only add noise, so
+            // the sequencer is left where it is like many emulators do.
+            if (length_.is_active() && linear_counter_ > 0 && period_ >= 2) {
+                step_ = (step_ + 1u) & 0x1Fu;
+            }
+        } else {
+            --timer_;
+        }
+    }
+
+    void clock_quarter_frame() {
+        if (linear_reload_) {
+            linear_counter_ = linear_reload_value_;
+        } else if (linear_counter_ > 0) {
+            --linear_counter_;
+        }
+        if (!control_) {
+            linear_reload_ = false;
+        }
+    }
+
+    void clock_half_frame() {
+        length_.clock();
+    }
+
+    [[nodiscard]] bool is_active() const {
+        return length_.is_active();
+    }
+
+    // 15 down to 0 and back up again. The output holds when the channel is
+    // silenced instead of dropping to 0.
+    [[nodiscard]] uint8_t output() const {
+        return step_ < 16 ? 15 - step_ : step_ - 16;
+    }
+
+private:
+    LengthCounter length_;
+
+    bool control_{false};
+    bool linear_reload_{false};
+    uint8_t linear_reload_value_{0};
+    uint8_t linear_counter_{0};
+
+    uint8_t step_{0};
+    uint16_t period_{0};
+    uint16_t timer_{0};
+};
+
+} // namespace n_e_s::core
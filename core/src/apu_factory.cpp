@@ -4,8 +4,17 @@
 
 namespace n_e_s::core {
 
-std::unique_ptr<IApu> ApuFactory::create() {
-    return std::make_unique<Apu>();
+std::unique_ptr<IApu> ApuFactory::create(Timing timing) {
+    switch (timing) {
+    case Timing::Pal:
+        return std::make_unique<Apu<Pal>>();
+    case Timing::Dendy:
+        return std::make_unique<Apu<Dendy>>();
+    case Timing::Ntsc:
+    case Timing::MultiRegion:
+        break;
+    }
+    return std::make_unique<Apu<Ntsc>>();
 }
 
-} // namespace n_e_s::core
\ No newline at end of file
+} // namespace n_e_s::core
@@ -0,0 +1,83 @@
+#include "nes/core/audio_ring_buffer.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace n_e_s::core {
+
+AudioRingBuffer::AudioRingBuffer(std::size_t capacity)
+        : mask_(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1),
+          samples_(std::make_unique<int16_t[]>(mask_ + 1)) {}
+
+std::size_t AudioRingBuffer::push(std::span<const int16_t> samples) {
+    const std::size_t write = write_.load(std::memory_order_relaxed);
+    const std::size_t read = read_.load(std::memory_order_acquire);
+    const std::size_t count =
+            std::min(samples.size(), capacity() - (write - read));
+
+    // At most two copies, before and after wrapping around.
+    const std::size_t start = write & mask_;
+    const std::size_t first = std::min(count, capacity() - start);
+    std::copy_n(samples.begin(), first, samples_.get() + start);
+    std::copy_n(samples.begin() + static_cast<std::ptrdiff_t>(first),
+            count - first,
+            samples_.get());
+    write_.store(write + count, std::memory_order_release);
+
+    if (count < samples.size()) {
+        overruns_.fetch_add(samples.size() - count, std::memory_order_relaxed);
+    }
+    return count;
+}
+
+std::size_t AudioRingBuffer::pop(std::span<int16_t> dst) {
+    const std::size_t read = read_.load(std::memory_order_relaxed);
+    const std::size_t write = write_.load(std::memory_order_acquire);
+    const std::size_t count = std::min(dst.size(), write - read);
+
+    const std::size_t start = read & mask_;
+    const std::size_t first = std::min(count, capacity() - start);
+    std::copy_n(samples_.get() + start, first, dst.begin());
+    std::copy_n(samples_.get(),
+            count - first,
+            dst.begin() + static_cast<std::ptrdiff_t>(first));
+    read_.store(read + count, std::memory_order_release);
+
+    if (count < dst.size()) {
+        std::fill(dst.begin() + static_cast<std::ptrdiff_t>(count),
+                dst.end(),
+                int16_t{0});
+        underruns_.fetch_add(dst.size() - count, std::memory_order_relaxed);
+    }
+    return count;
+}
+
+std::size_t AudioRingBuffer::size() const {
+    // Read first so that the size never appears negative.
+    const std::size_t read = read_.load(std::memory_order_acquire);
+    const std::size_t write = write_.load(std::memory_order_acquire);
+    return write - read;
+}
+
+// https://docs.libretro.com/development/cores/dynamic-rate-control/
+uint32_t AudioRingBuffer::adjusted_sample_rate(uint32_t sample_rate,
+        std::size_t target_size,
+        double max_deviation) const {
+    const auto current = static_cast<double>(size());
+    const auto target = static_cast<double>(
+            std::clamp<std::size_t>(target_size, 1, mask_));
+    // -1 when empty, 0 at the target and 1 when full.
+    const double error = current < target
+                                 ? (current - target) / target
+                                 : (current - target) /
+                                           (static_cast<double>(capacity()) -
+                                                   target);
+
+    // Produce more samples per emulated second while below the target.
+    const double ratio = 1.0 - std::clamp(error, -1.0, 1.0) * max_deviation;
+    return static_cast<uint32_t>(
+            std::lround(static_cast<double>(sample_rate) * ratio));
+}
+
+} // namespace n_e_s::core
@@ -0,0 +1,147 @@
+#include "nes/core/cpu_profiler.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+
+namespace n_e_s::core {
+namespace {
+
+bool is_jump(Family family) {
+    switch (family) {
+    case Family::BPL:
+    case Family::BMI:
+    case Family::BVC:
+    case Family::BVS:
+    case Family::BCC:
+    case Family::BCS:
+    case Family::BNE:
+    case Family::BEQ:
+    case Family::JMP:
+        return true;
+    default:
+        return false;
+    }
+}
+
+} // namespace
+
+CpuProfiler::CpuProfiler() : pcs_(0x10000) {}
+
+void CpuProfiler::sample(const CpuState &state) {
+    if (!state.current_opcode ||
+            (opcode_ && state.start_cycle == start_cycle_)) {
+        return;
+    }
+
+    if (opcode_ && state.start_cycle > start_cycle_) {
+        record(state.start_cycle, state.start_pc);
+    }
+
+    opcode_ = state.current_opcode;
+    start_pc_ = state.start_pc;
+    start_cycle_ = state.start_cycle;
+}
+
+void CpuProfiler::clear() {
+    opcodes_ = {};
+    address_modes_ = {};
+    std::fill(pcs_.begin(), pcs_.end(), Counter{});
+    loop_edges_.clear();
+    opcode_.reset();
+}
+
+const CpuProfiler::Counter &CpuProfiler::opcode(uint8_t opcode) const {
+    return opcodes_[opcode];
+}
+
+const CpuProfiler::Counter &CpuProfiler::address_mode(
+        AddressMode address_mode) const {
+    return address_modes_[static_cast<std::size_t>(address_mode)];
+}
+
+const CpuProfiler::Counter &CpuProfiler::pc(uint16_t pc) const {
+    return pcs_[pc];
+}
+
+std::vector<CpuProfiler::HotLoop> CpuProfiler::hot_loops(
+        std::size_t max_count) const {
+    std::vector<HotLoop> loops;
+    loops.reserve(loop_edges_.size());
+    for (const auto &[edge, iterations] : loop_edges_) {
+        HotLoop loop{edge.first, edge.second, iterations, 0};
+        for (uint32_t pc = loop.start_pc; pc <= loop.end_pc; ++pc) {
+            loop.cycles += pcs_[pc].cycles;
+        }
+        loops.push_back(loop);
+    }
+
+    std::sort(loops.begin(), loops.end(), [](const auto &a, const auto &b) {
+        return a.cycles > b.cycles;
+    });
+    if (loops.size() > max_count) {
+        loops.resize(max_count);
+    }
+    return loops;
+}
+
+void CpuProfiler::write_csv(std::ostream &os) const {
+    os << "kind,key,executions,cycles\n";
+
+    for (std::size_t i = 0; i < opcodes_.size(); ++i) {
+        const Counter &c = opcodes_[i];
+        if (c.executions > 0) {
+            const Opcode op = decode(static_cast<uint8_t>(i));
+            os << fmt::format("opcode,{:#04x} {} {},{},{}\n",
+                    i,
+                    to_string(op.family),
+                    to_string(op.address_mode),
+                    c.executions,
+                    c.cycles);
+        }
+    }
+
+    for (std::size_t i = 0; i < address_modes_.size(); ++i) {
+        const Counter &c = address_modes_[i];
+        if (c.executions > 0) {
+            os << fmt::format("address_mode,{},{},{}\n",
+                    to_string(static_cast<AddressMode>(i)),
+                    c.executions,
+                    c.cycles);
+        }
+    }
+
+    for (std::size_t i = 0; i < pcs_.size(); ++i) {
+        const Counter &c = pcs_[i];
+        if (c.executions > 0) {
+            os << fmt::format(
+                    "pc,{:#06x},{},{}\n", i, c.executions, c.cycles);
+        }
+    }
+
+    for (const HotLoop &loop : hot_loops(loop_edges_.size())) {
+        os << fmt::format("loop,{:#06x}-{:#06x},{},{}\n",
+                loop.start_pc,
+                loop.end_pc,
+                loop.iterations,
+                loop.cycles);
+    }
+}
+
+void CpuProfiler::record(uint64_t next_start_cycle, uint16_t next_pc) {
+    const uint64_t cycles = next_start_cycle - start_cycle_;
+
+    const auto count = [cycles](Counter &c) {
+        ++c.executions;
+        c.cycles += cycles;
+    };
+    count(opcodes_[opcode_->instruction]);
+    count(address_modes_[static_cast<std::size_t>(opcode_->address_mode)]);
+    count(pcs_[start_pc_]);
+
+    if (next_pc <= start_pc_ && is_jump(opcode_->family)) {
+        ++loop_edges_[{next_pc, start_pc_}];
+    }
+}
+
+} // namespace n_e_s::core
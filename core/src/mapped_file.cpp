@@ -0,0 +1,158 @@
+#include "mapped_file.h"
+
+#include <fmt/format.h>
+
+#include <stdexcept>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define N_E_S_HAS_MMAP
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#include <iterator>
+#include <system_error>
+#endif
+
+namespace n_e_s::core {
+
+#ifdef N_E_S_HAS_MMAP
+
+MappedFile::MappedFile(const std::filesystem::path &path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error(
+                fmt::format("Unable to open {}", path.string()));
+    }
+
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error(
+                fmt::format("Unable to stat {}", path.string()));
+    }
+
+    const auto size = static_cast<std::size_t>(st.st_size);
+    if (size == 0) {
+        ::close(fd);
+        return;
+    }
+
+    // The mapping stays valid after the file is closed.
+    void *const data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        throw std::runtime_error(
+                fmt::format("Unable to map {}", path.string()));
+    }
+
+    bytes_ = std::span(static_cast<uint8_t *>(data), size);
+}
+
+MappedFile::MappedFile(const std::filesystem::path &path, std::size_t size) {
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        throw std::runtime_error(
+                fmt::format("Unable to open {}", path.string()));
+    }
+
+    // The destructor doesn't run if this throws.
+    const auto fail = [this](const std::string &message) {
+        ::close(fd_);
+        throw std::runtime_error(message);
+    };
+
+    // The lock is held until the file is closed, so that no one else writes
+    // to the same mapping.
+    if (::flock(fd_, LOCK_EX | LOCK_NB) != 0) {
+        fail(fmt::format("{} is in use", path.string()));
+    }
+
+    struct stat st {};
+    if (::fstat(fd_, &st) != 0) {
+        fail(fmt::format("Unable to stat {}", path.string()));
+    }
+
+    const auto file_size = static_cast<std::size_t>(st.st_size);
+    if (file_size != 0 && file_size < size) {
+        fail(fmt::format(
+                "{} is {} bytes, expected {}", path.string(), file_size, size));
+    }
+
+    if (file_size == 0 && ::ftruncate(fd_, static_cast<off_t>(size)) != 0) {
+        fail(fmt::format("Unable to resize {}", path.string()));
+    }
+
+    if (size == 0) {
+        return;
+    }
+
+    // Shared mappings are written back to the file by the kernel.
+    void *const data = ::mmap(
+            nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (data == MAP_FAILED) {
+        fail(fmt::format("Unable to map {}", path.string()));
+    }
+
+    bytes_ = std::span(static_cast<uint8_t *>(data), size);
+}
+
+MappedFile::~MappedFile() {
+    if (buffer_.empty() && !bytes_.empty()) {
+        ::munmap(bytes_.data(), bytes_.size());
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+#else
+
+MappedFile::MappedFile(const std::filesystem::path &path) {
+    std::ifstream fs(path, std::ios::binary);
+    if (!fs) {
+        throw std::runtime_error(
+                fmt::format("Unable to open {}", path.string()));
+    }
+
+    buffer_.assign(std::istreambuf_iterator<char>(fs),
+            std::istreambuf_iterator<char>());
+    bytes_ = buffer_;
+}
+
+MappedFile::MappedFile(const std::filesystem::path &path, std::size_t size)
+        : buffer_(size), write_back_path_(path) {
+    // A missing file is created when writing back.
+    std::error_code ec;
+    const std::uintmax_t file_size = std::filesystem::file_size(path, ec);
+    if (!ec && file_size != 0 && file_size < size) {
+        throw std::runtime_error(fmt::format(
+                "{} is {} bytes, expected {}", path.string(), file_size, size));
+    }
+
+    std::ifstream fs(path, std::ios::binary);
+    fs.read(reinterpret_cast<char *>(buffer_.data()),
+            static_cast<std::streamsize>(size));
+    bytes_ = buffer_;
+}
+
+MappedFile::~MappedFile() {
+    if (!write_back_path_.empty()) {
+        // Only overwrite the start of existing files.
+        std::fstream fs(write_back_path_,
+                std::ios::binary | std::ios::in | std::ios::out);
+        if (!fs) {
+            fs.open(write_back_path_, std::ios::binary | std::ios::out);
+        }
+        fs.write(reinterpret_cast<const char *>(buffer_.data()),
+                static_cast<std::streamsize>(buffer_.size()));
+    }
+}
+
+#endif
+
+} // namespace n_e_s::core
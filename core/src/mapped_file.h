@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+namespace n_e_s::core {
+
+// A view of a whole file. Where supported the file is memory mapped, so its
+// pages are only loaded when touched and are shared with everyone else
+// mapping the same file. Elsewhere it's read into memory.
+class MappedFile {
+public:
+    // Maps the file read-only.
+    explicit MappedFile(const std::filesystem::path &path);
+
+    // Maps the first size bytes of the file for writing, creating the file
+    // if it's missing or empty. Larger files are left as they are, but files
+    // that are smaller are refused rather than silently padded, as are files
+    // that someone else has mapped for writing where mapping is supported.
+    // Writes go straight to the file, or where mapping isn't supported, are
+    // written back when this is destroyed.
+    MappedFile(const std::filesystem::path &path, std::size_t size);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    [[nodiscard]] std::span<const uint8_t> bytes() const {
+        return bytes_;
+    }
+
+    // Only valid if the file was mapped for writing.
+    [[nodiscard]] std::span<uint8_t> writable_bytes() {
+        return bytes_;
+    }
+
+private:
+    std::span<uint8_t> bytes_;
+    std::vector<uint8_t> buffer_; // Only used if the file isn't mapped.
+    std::filesystem::path write_back_path_; // Ditto, if mapped for writing.
+    int fd_{-1}; // Kept open to hold the lock if mapped for writing.
+};
+
+} // namespace n_e_s::core
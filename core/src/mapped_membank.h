@@ -2,21 +2,28 @@
 
 #include "membank_base.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <functional>
+#include <span>
 
 namespace n_e_s::core {
 
 // A mapped membank will always forward calls to the registered
-// reader and writer.
+// reader and writer. Peeking uses the peeker if there is one and reads 0
+// otherwise, as the reader may have side effects.
 template <uint16_t StartAddr, uint16_t EndAddr, uint16_t Size>
 class MappedMemBank final : public MemBankBase<StartAddr, EndAddr, Size> {
 public:
     using ByteReader = std::function<uint8_t(uint16_t)>;
     using ByteWriter = std::function<void(uint16_t, uint8_t)>;
 
-    MappedMemBank(ByteReader reader, ByteWriter writer)
-            : reader_{std::move(reader)}, writer_{std::move(writer)} {}
+    MappedMemBank(ByteReader reader,
+            ByteWriter writer,
+            ByteReader peeker = {})
+            : reader_{std::move(reader)},
+              writer_{std::move(writer)},
+              peeker_{std::move(peeker)} {}
 
     uint8_t read_byte(uint16_t addr) const override {
         addr %= Size;
@@ -28,9 +35,26 @@ public:
         writer_(StartAddr + addr, byte);
     }
 
+    void peek_block(uint16_t addr, std::span<uint8_t> dst) const override {
+        if (!peeker_) {
+            std::fill(dst.begin(), dst.end(), uint8_t{0});
+            return;
+        }
+
+        for (uint8_t &byte : dst) {
+            byte = peeker_(StartAddr + addr % Size);
+            ++addr;
+        }
+    }
+
+    uint8_t peek_byte(uint16_t addr) const override {
+        return peeker_ ? peeker_(StartAddr + addr % Size) : 0;
+    }
+
 private:
     ByteReader reader_;
     ByteWriter writer_;
+    ByteReader peeker_;
 };
 
 } // namespace n_e_s::core
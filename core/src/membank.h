@@ -1,9 +1,11 @@
 #pragma once
 
 #include "membank_base.h"
+#include "mirrored_memory.h"
 
 #include <array>
 #include <cstdint>
+#include <span>
 #include <utility>
 
 namespace n_e_s::core {
@@ -19,6 +21,22 @@ public:
         *get_location(addr) = byte;
     }
 
+    uint8_t peek_byte(uint16_t addr) const override {
+        return *get_location(addr);
+    }
+
+    void read_block(uint16_t addr, std::span<uint8_t> dst) const override {
+        read_mirrored(bank_, addr % Size, dst);
+    }
+
+    void write_block(uint16_t addr, std::span<const uint8_t> src) override {
+        write_mirrored(bank_, addr % Size, src);
+    }
+
+    std::span<uint8_t> direct_memory(uint16_t addr) override {
+        return std::span(bank_).subspan(addr % Size);
+    }
+
 private:
     uint8_t *get_location(uint16_t addr) {
         return const_cast<uint8_t *>(std::as_const(*this).get_location(addr));
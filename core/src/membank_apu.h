@@ -0,0 +1,70 @@
+#pragma once
+
+#include "nes/core/iapu.h"
+#include "nes/core/imembank.h"
+
+#include <cstdint>
+#include <span>
+
+namespace n_e_s::core {
+
+// The apu registers at $4000-$4015. $4017 is shared with the second
+// controller port, so writes to it are forwarded by MemBankControllerIO
+// instead.
+//
+// Only the status at $4015 can be read, the other registers are write-only
+// and read open bus. $4014 starts the sprite dma, which isn't implemented
+// yet, so writes to it are accepted and dropped.
+class MemBankApu : public IMemBank {
+public:
+    explicit MemBankApu(IApu *apu) : apu_(apu) {}
+
+    bool is_address_in_range(uint16_t addr) const override {
+        return addr >= 0x4000 && addr <= 0x4015;
+    }
+
+    uint8_t read_byte(uint16_t addr) const override {
+        if (addr != kStatus) {
+            return open_bus();
+        }
+        return apu_->read_byte(addr);
+    }
+
+    void write_byte(uint16_t addr, uint8_t byte) override {
+        if (addr == kOamDma) {
+            return;
+        }
+        apu_->write_byte(addr, byte);
+    }
+
+    // Peeking the status doesn't clear the frame irq like reading it does.
+    void peek_block(uint16_t addr, std::span<uint8_t> dst) const override {
+        for (uint8_t &byte : dst) {
+            byte = peek_byte(addr++);
+        }
+    }
+
+    uint8_t peek_byte(uint16_t addr) const override {
+        if (addr != kStatus) {
+            return open_bus();
+        }
+        return apu_->peek_byte(addr);
+    }
+
+    void set_open_bus(const uint8_t *open_bus) override {
+        open_bus_ = open_bus;
+    }
+
+private:
+    static constexpr uint16_t kOamDma{0x4014};
+    static constexpr uint16_t kStatus{0x4015};
+
+    uint8_t open_bus() const {
+        return open_bus_ != nullptr ? *open_bus_ : 0x00;
+    }
+
+    IApu *apu_;
+    const uint8_t *open_bus_{nullptr};
+};
+
+} // namespace n_e_s::core
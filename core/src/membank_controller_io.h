@@ -1,15 +1,24 @@
 #pragma once
 
+#include "nes/core/iapu.h"
 #include "nes/core/imembank.h"
 #include "nes/core/ines_controller.h"
 
+#include <cstdint>
+#include <span>
+
 namespace n_e_s::core {
 
+// Writes to $4017 go to the apu's frame counter rather than the second
+// controller.
 class MemBankControllerIO : public IMemBank {
 public:
     MemBankControllerIO(INesController *controller1,
-            INesController *controller2)
-            : controller1_(controller1), controller2_(controller2) {}
+            INesController *controller2,
+            IApu *apu)
+            : controller1_(controller1),
+              controller2_(controller2),
+              apu_(apu) {}
 
     bool is_address_in_range(uint16_t addr) const override {
         return (addr == controller1_addr_) || (addr == controller2_addr_);
@@ -24,19 +33,57 @@ public:
         // this behavior and require that reads from the controller ports
         // return exactly $40 or $41 as appropriate.
 
-        INesController *controller{};
-        uint8_t read_cnt{0};
+        if (addr == controller1_addr_) {
+            return read_controller(controller1_, read_cnt1_++);
+        }
+        if (addr == controller2_addr_) {
+            return read_controller(controller2_, read_cnt2_++);
+        }
+        return 0x00;
+    }
+
+    // Reads what the next read_byte would without advancing the controllers.
+    void peek_block(uint16_t addr, std::span<uint8_t> dst) const override {
+        for (uint8_t &byte : dst) {
+            if (addr == controller1_addr_) {
+                byte = read_controller(controller1_, read_cnt1_);
+            } else if (addr == controller2_addr_) {
+                byte = read_controller(controller2_, read_cnt2_);
+            } else {
+                byte = 0x00;
+            }
+            ++addr;
+        }
+    }
+
+    uint8_t peek_byte(uint16_t addr) const override {
+        if (addr == controller1_addr_) {
+            return read_controller(controller1_, read_cnt1_);
+        }
+        if (addr == controller2_addr_) {
+            return read_controller(controller2_, read_cnt2_);
+        }
+        return 0x00;
+    }
 
+    void write_byte(uint16_t addr, uint8_t data) override {
         if (addr == controller1_addr_) {
-            controller = controller1_;
-            read_cnt = read_cnt1_++;
+            if (((data1_ & static_cast<uint8_t>(0x01)) == 0x01) &&
+                    ((data & static_cast<uint8_t>(0x01)) == 0x00)) {
+                // Neg flank on bit 0 should latch controller button states -
+                // here just make sure counters is reset
+                read_cnt1_ = 0;
+                read_cnt2_ = 0;
+            }
+            data1_ = data;
         } else if (addr == controller2_addr_) {
-            controller = controller2_;
-            read_cnt = read_cnt2_++;
-        } else {
-            return 0x00;
+            apu_->write_byte(addr, data);
         }
+    }
 
+private:
+    uint8_t read_controller(INesController *controller,
+            uint8_t read_cnt) const {
         uint8_t data = 0x40;
         uint8_t btn = 0x00;
 
@@ -81,28 +128,12 @@ public:
         return data;
     }
 
-    void write_byte(uint16_t addr, uint8_t data) override {
-        if (addr == controller1_addr_) {
-            if (((data1_ & static_cast<uint8_t>(0x01)) == 0x01) &&
-                    ((data & static_cast<uint8_t>(0x01)) == 0x00)) {
-                // Neg flank on bit 0 should latch controller button states -
-                // here just make sure counters is reset
-                read_cnt1_ = 0;
-                read_cnt2_ = 0;
-            }
-            data1_ = data;
-        } else if (addr == controller2_addr_) {
-            data2_ = data;
-        }
-    }
-
-private:
     INesController *controller1_;
     INesController *controller2_;
+    IApu *apu_;
     mutable uint8_t read_cnt1_{0};
     mutable uint8_t read_cnt2_{0};
     uint8_t data1_{0};
-    uint8_t data2_{0};
 
     const uint16_t controller1_addr_{0x4016};
     const uint16_t controller2_addr_{0x4017};
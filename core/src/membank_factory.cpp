@@ -1,9 +1,11 @@
 #include "nes/core/membank_factory.h"
 
 #include <memory>
+#include <span>
 
 #include "mapped_membank.h"
 #include "membank.h"
+#include "membank_apu.h"
 #include "membank_controller_io.h"
 #include "nes/core/ippu.h"
 #include "nes/core/irom.h"
@@ -23,6 +25,12 @@ public:
     void write_byte(uint16_t addr, uint8_t byte) override {
         rom_->cpu_write_byte(addr, byte);
     }
+    void read_block(uint16_t addr, std::span<uint8_t> dst) const override {
+        rom_->cpu_read_block(addr, dst);
+    }
+    uint8_t peek_byte(uint16_t addr) const override {
+        return rom_->cpu_read_byte(addr);
+    }
 
 private:
     IRom *rom_;
@@ -40,6 +48,12 @@ public:
     void write_byte(uint16_t addr, uint8_t byte) override {
         rom_->ppu_write_byte(addr, byte);
     }
+    void read_block(uint16_t addr, std::span<uint8_t> dst) const override {
+        rom_->ppu_read_block(addr, dst);
+    }
+    uint8_t peek_byte(uint16_t addr) const override {
+        return rom_->ppu_read_byte(addr);
+    }
 
 private:
     IRom *rom_;
@@ -56,6 +70,7 @@ auto create_ppu_writer(IPpu *ppu) {
 } // namespace
 
 MemBankList MemBankFactory::create_nes_mem_banks(IPpu *ppu,
+        IApu *apu,
         IRom *rom,
         INesController *controller1,
         INesController *controller2) {
@@ -73,16 +88,13 @@ MemBankList MemBankFactory::create_nes_mem_banks(IPpu *ppu,
             create_ppu_reader(ppu), create_ppu_writer(ppu)));
 
     // Io
-    mem_banks.push_back(std::make_unique<MemBank<0x4000, 0x4015, 0x16>>());
-    mem_banks.push_back(
-            std::make_unique<MemBankControllerIO>(controller1, controller2));
+    mem_banks.push_back(std::make_unique<MemBankApu>(apu));
+    mem_banks.push_back(std::make_unique<MemBankControllerIO>(
+            controller1, controller2, apu));
 
     // Io dev
     mem_banks.push_back(std::make_unique<MemBank<0x4018, 0x401F, 0x8>>());
 
-    // Empty SRAM
-    mem_banks.push_back(std::make_unique<MemBank<0x6000, 0x7FFF, 0x8>>());
-
     // Expansion ROM
     mem_banks.push_back(std::make_unique<MemBank<0x4020, 0x5FFF, 0x8>>());
 
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+namespace n_e_s::core {
+
+// Copies between memory and a block the way mirrored memory is seen from the
+// bus, starting at offset and wrapping around to the start of the memory
+// whenever its end is reached.
+
+inline void read_mirrored(std::span<const uint8_t> memory,
+        std::size_t offset,
+        std::span<uint8_t> dst) {
+    offset %= memory.size();
+    while (!dst.empty()) {
+        const std::size_t count = std::min(dst.size(), memory.size() - offset);
+        std::memcpy(dst.data(), memory.data() + offset, count);
+        dst = dst.subspan(count);
+        offset = 0;
+    }
+}
+
+inline void write_mirrored(std::span<uint8_t> memory,
+        std::size_t offset,
+        std::span<const uint8_t> src) {
+    offset %= memory.size();
+    while (!src.empty()) {
+        const std::size_t count = std::min(src.size(), memory.size() - offset);
+        std::memcpy(memory.data() + offset, src.data(), count);
+        src = src.subspan(count);
+        offset = 0;
+    }
+}
+
+} // namespace n_e_s::core
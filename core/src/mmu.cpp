@@ -21,11 +21,15 @@ void Mmu::clear() {
 }
 
 void Mmu::add_mem_bank(std::unique_ptr<IMemBank> mem_bank) {
+    mem_bank->set_open_bus(&open_bus_);
     mem_banks_.push_back(std::move(mem_bank));
 }
 
 void Mmu::set_mem_banks(MemBankList mem_banks) {
     mem_banks_ = std::move(mem_banks);
+    for (const auto &mem_bank : mem_banks_) {
+        mem_bank->set_open_bus(&open_bus_);
+    }
 }
 
 IMemBank *Mmu::get_mem_bank(uint16_t addr) const {
@@ -37,18 +41,149 @@ IMemBank *Mmu::get_mem_bank(uint16_t addr) const {
     return nullptr;
 }
 
+std::size_t Mmu::run_length(uint16_t addr,
+        const IMemBank *mem_bank,
+        std::size_t max_count) const {
+    // The addresses a mem bank handles are contiguous, so binary search for
+    // the last one in the block that is still handled by the same mem bank.
+    std::size_t in_run = 1;
+    std::size_t maybe_in_run = max_count;
+    while (in_run < maybe_in_run) {
+        const std::size_t count = in_run + (maybe_in_run - in_run + 1) / 2;
+        if (get_mem_bank(static_cast<uint16_t>(addr + count - 1)) ==
+                mem_bank) {
+            in_run = count;
+        } else {
+            maybe_in_run = count - 1;
+        }
+    }
+    return in_run;
+}
+
+template <typename Fn>
+void Mmu::for_each_run(uint16_t addr, std::size_t size, Fn fn) const {
+    std::size_t offset = 0;
+    while (offset < size) {
+        IMemBank *mem_bank = get_mem_bank(addr);
+        // Invalid addresses are handled one at a time as they don't have to
+        // be contiguous.
+        std::size_t count = 1;
+        if (mem_bank != nullptr) {
+            const std::size_t until_wrap = 0x10000u - addr;
+            count = run_length(
+                    addr, mem_bank, std::min(size - offset, until_wrap));
+        }
+
+        fn(mem_bank, addr, offset, count);
+        offset += count;
+        addr = static_cast<uint16_t>(addr + count);
+    }
+}
+
 uint8_t Mmu::read_byte(uint16_t addr) const {
     if (const IMemBank *mem_bank = get_mem_bank(addr)) {
-        return mem_bank->read_byte(addr);
+        open_bus_ = mem_bank->read_byte(addr);
+        return open_bus_;
     }
 
-    throw InvalidAddress(addr);
+    return invalid_read(addr);
 }
 
 void Mmu::write_byte(uint16_t addr, uint8_t byte) {
+    open_bus_ = byte;
     if (IMemBank *mem_bank = get_mem_bank(addr)) {
         mem_bank->write_byte(addr, byte);
     } else {
+        invalid_write(addr);
+    }
+}
+
+void Mmu::read_block(uint16_t addr, std::span<uint8_t> dst) const {
+    for_each_run(addr,
+            dst.size(),
+            [&](const IMemBank *mem_bank,
+                    uint16_t run_addr,
+                    std::size_t offset,
+                    std::size_t count) {
+                if (mem_bank != nullptr) {
+                    mem_bank->read_block(run_addr, dst.subspan(offset, count));
+                    open_bus_ = dst[offset + count - 1];
+                } else {
+                    dst[offset] = invalid_read(run_addr);
+                }
+            });
+}
+
+void Mmu::write_block(uint16_t addr, std::span<const uint8_t> src) {
+    for_each_run(addr,
+            src.size(),
+            [&](IMemBank *mem_bank,
+                    uint16_t run_addr,
+                    std::size_t offset,
+                    std::size_t count) {
+                open_bus_ = src[offset + count - 1];
+                if (mem_bank != nullptr) {
+                    mem_bank->write_block(run_addr, src.subspan(offset, count));
+                } else {
+                    invalid_write(run_addr);
+                }
+            });
+}
+
+void Mmu::peek_block(uint16_t addr, std::span<uint8_t> dst) const {
+    for_each_run(addr,
+            dst.size(),
+            [&](const IMemBank *mem_bank,
+                    uint16_t run_addr,
+                    std::size_t offset,
+                    std::size_t count) {
+                if (mem_bank != nullptr) {
+                    mem_bank->peek_block(run_addr, dst.subspan(offset, count));
+                } else {
+                    dst[offset] = open_bus_;
+                }
+            });
+}
+
+uint8_t Mmu::peek_byte(uint16_t addr) const {
+    if (const IMemBank *mem_bank = get_mem_bank(addr)) {
+        return mem_bank->peek_byte(addr);
+    }
+
+    return open_bus_;
+}
+
+std::span<uint8_t> Mmu::direct_memory(uint16_t addr) {
+    if (IMemBank *mem_bank = get_mem_bank(addr)) {
+        return mem_bank->direct_memory(addr);
+    }
+    return {};
+}
+
+uint8_t *Mmu::open_bus() {
+    return &open_bus_;
+}
+
+void Mmu::set_strict(bool strict) {
+    strict_ = strict;
+}
+
+uint64_t Mmu::invalid_access_count() const {
+    return invalid_accesses_;
+}
+
+uint8_t Mmu::invalid_read(uint16_t addr) const {
+    ++invalid_accesses_;
+    if (strict_) {
+        throw InvalidAddress(addr);
+    }
+
+    return open_bus_;
+}
+
+void Mmu::invalid_write(uint16_t addr) {
+    ++invalid_accesses_;
+    if (strict_) {
         throw InvalidAddress(addr);
     }
 }
@@ -3,8 +3,10 @@
 #include "nes/core/imembank.h"
 #include "nes/core/immu.h"
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <span>
 #include <vector>
 
 namespace n_e_s::core {
@@ -19,10 +21,41 @@ public:
     uint8_t read_byte(uint16_t addr) const override;
     void write_byte(uint16_t addr, uint8_t byte) override;
 
+    void read_block(uint16_t addr, std::span<uint8_t> dst) const override;
+    void write_block(uint16_t addr, std::span<const uint8_t> src) override;
+    void peek_block(uint16_t addr, std::span<uint8_t> dst) const override;
+    uint8_t peek_byte(uint16_t addr) const override;
+
+    std::span<uint8_t> direct_memory(uint16_t addr) override;
+    uint8_t *open_bus() override;
+
+    void set_strict(bool strict) override;
+    uint64_t invalid_access_count() const override;
+
 private:
     IMemBank *get_mem_bank(uint16_t addr) const;
 
+    // Returns how many addresses starting at addr, at most max_count, are
+    // handled by mem_bank.
+    std::size_t run_length(uint16_t addr,
+            const IMemBank *mem_bank,
+            std::size_t max_count) const;
+
+    // Calls fn(mem_bank, addr, offset, count) for every run of addresses
+    // handled by the same mem bank, mem_bank is nullptr for invalid
+    // addresses.
+    template <typename Fn>
+    void for_each_run(uint16_t addr, std::size_t size, Fn fn) const;
+
+    uint8_t invalid_read(uint16_t addr) const;
+    void invalid_write(uint16_t addr);
+
     std::vector<std::unique_ptr<IMemBank>> mem_banks_{};
+
+    // The last byte read from or written to the bus.
+    mutable uint8_t open_bus_{};
+    mutable uint64_t invalid_accesses_{};
+    bool strict_{false};
 };
 
 } // namespace n_e_s::core
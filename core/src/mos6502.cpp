@@ -1,14 +1,17 @@
 #include "mos6502.h"
 
 #include "nes/core/opcode.h"
+#include "nes/core/trace.h"
 
 #include <fmt/format.h>
+#include <algorithm>
 #include <stdexcept>
 
 namespace {
 
 const uint16_t kResetAddress = 0xFFFC; // This is where the reset routine is.
 const uint16_t kBrkAddress = 0xFFFE; // This is where the break routine is.
+const uint16_t kIrqAddress = 0xFFFE; // Irqs share the vector with break.
 
 constexpr bool is_negative(uint8_t byte) {
     return (byte & (1u << 7u)) != 0;
@@ -33,6 +36,13 @@ constexpr uint16_t high_byte(uint16_t word) {
     return word & static_cast<uint16_t>(0xFF00u);
 }
 
+// Returns true if fetching length instruction bytes from pc can't have any
+// side effects, i.e. they're in internal RAM or cartridge space.
+constexpr bool is_side_effect_free_code(uint16_t pc, uint16_t length) {
+    const uint32_t end = static_cast<uint32_t>(pc) + length;
+    return end <= 0x0800 || (pc >= 0x6000 && end <= 0x10000);
+}
+
 // Returns true if accessing an index address will require the cpu to reach
 // across a page boundary.
 constexpr bool cross_page(uint16_t address, uint8_t index) {
@@ -47,37 +57,261 @@ namespace n_e_s::core {
 Mos6502::Stack::Stack(CpuRegisters *registers, IMmu *mmu)
         : registers_(registers), mmu_(mmu) {}
 
+void Mos6502::Stack::set_ram(std::span<uint8_t> ram, uint8_t *open_bus) {
+    open_bus_ = open_bus;
+    page_ = ram.size() >= ram_offset_ + 0x100u ? &ram[ram_offset_] : nullptr;
+}
+
 uint8_t Mos6502::Stack::pop_byte() {
+    if (page_ != nullptr) {
+        *open_bus_ = page_[++registers_->sp];
+        return *open_bus_;
+    }
     return mmu_->read_byte(ram_offset_ + ++registers_->sp);
 }
 
 void Mos6502::Stack::push_byte(uint8_t byte) {
-    mmu_->write_byte(ram_offset_ + registers_->sp--, byte);
+    if (page_ != nullptr) {
+        *open_bus_ = byte;
+        page_[registers_->sp--] = byte;
+    } else {
+        mmu_->write_byte(ram_offset_ + registers_->sp--, byte);
+    }
 }
 
 Mos6502::Mos6502(CpuRegisters *const registers, IMmu *const mmu)
-        : registers_(registers), mmu_(mmu), stack_(registers_, mmu_) {}
+        : registers_(registers), mmu_(mmu), stack_(registers_, mmu_) {
+    irq_schedule_.fill(kNotScheduled);
+}
 
 void Mos6502::execute() {
+    if (state_.cycle >= next_dma_event_) {
+        execute_dma();
+        ++state_.cycle;
+        return;
+    }
+
+    if (idle_loop_ && execute_idle_loop()) {
+        ++state_.cycle;
+        return;
+    }
+
     if (pipeline_.done()) {
+        trace_instruction();
         if (nmi_) {
+            if (Trace::enabled()) {
+                Trace::instant("NMI");
+            }
             pipeline_ = create_nmi();
             nmi_ = false;
+        } else if (irq_pending()) {
+            if (Trace::enabled()) {
+                Trace::instant("IRQ");
+            }
+            pipeline_ = create_irq();
+        } else if (idle_loop_detection_ &&
+                   (idle_loop_ = find_idle_loop()).has_value()) {
+            execute_idle_loop();
         } else {
             pipeline_ = parse_next_instruction();
         }
     } else {
+        irq_inhibit_ = (registers_->p & I_FLAG) != 0;
         pipeline_.execute_step();
     }
     ++state_.cycle;
 }
 
+bool Mos6502::irq_pending() {
+    if (state_.cycle >= next_scheduled_irq_) {
+        assert_scheduled_irqs();
+    }
+    return irq_sources_ != 0 && !irq_inhibit_;
+}
+
+bool Mos6502::interrupt_pending() {
+    return nmi_ || irq_pending();
+}
+
+void Mos6502::assert_scheduled_irqs() {
+    next_scheduled_irq_ = kNotScheduled;
+    for (std::size_t i = 0; i < irq_schedule_.size(); ++i) {
+        if (irq_schedule_[i] <= state_.cycle) {
+            irq_sources_ |= static_cast<uint8_t>(1u << i);
+            irq_schedule_[i] = kNotScheduled;
+        }
+        next_scheduled_irq_ = std::min(next_scheduled_irq_, irq_schedule_[i]);
+    }
+}
+
+// One scope per instruction, as one per cycle would flood the trace.
+void Mos6502::trace_instruction() {
+    if (instruction_traced_) {
+        Trace::end(kInstructionTrace);
+        instruction_traced_ = false;
+    }
+    if (Trace::enabled()) {
+        Trace::begin(kInstructionTrace);
+        instruction_traced_ = true;
+    }
+}
+
+// https://www.nesdev.org/wiki/DMA#DMC_DMA
+void Mos6502::execute_dma() {
+    if (dma_stall_cycles_ == 0) {
+        // Halting, a dummy cycle, an alignment cycle and the read. The
+        // halt is 1 cycle shorter if it lands on a write, which isn't
+        // modelled.
+        dma_stall_cycles_ = 4;
+        scheduled_dma_ = kNotScheduled;
+        // The handler reads the sample and may schedule the next dma.
+        dma_handler_();
+    }
+
+    --dma_stall_cycles_;
+    next_dma_event_ =
+            dma_stall_cycles_ > 0 ? state_.cycle + 1 : scheduled_dma_;
+}
+
+std::optional<Mos6502::IdleLoop> Mos6502::find_idle_loop() const {
+    const uint16_t pc = registers_->pc;
+    if (interrupted_ || !state_.current_opcode) {
+        return std::nullopt;
+    }
+
+    const Opcode last = *state_.current_opcode;
+    if (last.instruction == Instruction::JmpAbsolute &&
+            state_.start_pc == pc && is_side_effect_free_code(pc, 3)) {
+        return IdleLoop{last, pc, 0, last, pc, 3, 3, false};
+    }
+
+    if (last.address_mode != AddressMode::Relative ||
+            !previous_state_.current_opcode ||
+            previous_state_.start_pc != pc) {
+        return std::nullopt;
+    }
+
+    const Opcode load = *previous_state_.current_opcode;
+    const bool is_poll = load.family == Family::LDA ||
+                         load.family == Family::LDX ||
+                         load.family == Family::LDY ||
+                         load.family == Family::BIT;
+    uint16_t load_length = 0;
+    if (load.address_mode == AddressMode::Zeropage) {
+        load_length = 2;
+    } else if (load.address_mode == AddressMode::Absolute) {
+        load_length = 3;
+    }
+
+    if (!is_poll || load_length == 0 || pc + load_length != state_.start_pc ||
+            !is_side_effect_free_code(pc, load_length + 2)) {
+        return std::nullopt;
+    }
+
+    // The branch hasn't touched the effective address of the load.
+    return IdleLoop{load,
+            pc,
+            effective_address_,
+            last,
+            state_.start_pc,
+            static_cast<uint8_t>(
+                    state_.start_cycle - previous_state_.start_cycle),
+            static_cast<uint8_t>(state_.cycle - previous_state_.start_cycle),
+            true};
+}
+
+// Replays the bus and register effects of the idle loop. Only the fetches of
+// the instruction bytes are skipped, and those are known to be free of side
+// effects. Interrupts and leaving the loop are handled by the normal path at
+// the same instruction boundaries as they would have been.
+bool Mos6502::execute_idle_loop() {
+    const IdleLoop &loop = *idle_loop_;
+
+    if (idle_loop_cycle_ == 0) {
+        if (interrupt_pending() || !idle_loop_detection_) {
+            registers_->pc = loop.load_pc;
+            idle_loop_.reset();
+            return false;
+        }
+        registers_->pc = loop.load_pc + 1;
+        previous_state_ = state_;
+        state_.current_opcode = loop.load;
+        state_.start_pc = loop.load_pc;
+        state_.start_cycle = state_.cycle;
+    } else if (loop.polls_address &&
+               idle_loop_cycle_ == loop.load_cycles - 1) {
+        const uint8_t value = read_byte(loop.address);
+        if (loop.load.family == Family::BIT) {
+            set_zero(value & registers_->a);
+            set_negative(value);
+            if (value & (1u << 6u)) {
+                set_flag(V_FLAG);
+            } else {
+                clear_flag(V_FLAG);
+            }
+        } else {
+            if (loop.load.family == Family::LDX) {
+                registers_->x = value;
+            } else if (loop.load.family == Family::LDY) {
+                registers_->y = value;
+            } else {
+                registers_->a = value;
+            }
+            set_zero(value);
+            set_negative(value);
+        }
+    } else if (loop.polls_address && idle_loop_cycle_ == loop.load_cycles) {
+        if (interrupt_pending() || !idle_loop_detection_ ||
+                !is_branch_taken(loop.branch.family)) {
+            registers_->pc = loop.branch_pc;
+            idle_loop_.reset();
+            idle_loop_cycle_ = 0;
+            return false;
+        }
+        registers_->pc = loop.branch_pc + 1;
+        previous_state_ = state_;
+        state_.current_opcode = loop.branch;
+        state_.start_pc = loop.branch_pc;
+        state_.start_cycle = state_.cycle;
+    }
+
+    if (++idle_loop_cycle_ == loop.period) {
+        idle_loop_cycle_ = 0;
+    }
+    return true;
+}
+
+bool Mos6502::is_branch_taken(Family family) const {
+    switch (family) {
+    case Family::BPL:
+        return !(registers_->p & N_FLAG);
+    case Family::BMI:
+        return registers_->p & N_FLAG;
+    case Family::BVC:
+        return !(registers_->p & V_FLAG);
+    case Family::BVS:
+        return registers_->p & V_FLAG;
+    case Family::BCC:
+        return !(registers_->p & C_FLAG);
+    case Family::BCS:
+        return registers_->p & C_FLAG;
+    case Family::BNE:
+        return !(registers_->p & Z_FLAG);
+    case Family::BEQ:
+        return registers_->p & Z_FLAG;
+    default:
+        return false;
+    }
+}
+
 // Most instruction timings are from https://robinli.eu/f/6502_cpu.txt
 Pipeline Mos6502::parse_next_instruction() {
+    previous_state_ = state_;
+    interrupted_ = false;
     state_.start_pc = registers_->pc;
     state_.start_cycle = state_.cycle;
 
-    const uint8_t raw_opcode{mmu_->read_byte(registers_->pc++)};
+    const uint8_t raw_opcode{read_byte(registers_->pc++)};
     state_.current_opcode = decode(raw_opcode);
 
     const MemoryAccess memory_access =
@@ -99,7 +333,7 @@ Pipeline Mos6502::parse_next_instruction() {
     case Instruction::BrkImplied:
         result.push([this] {
             // Dummy read
-            mmu_->read_byte(registers_->pc++);
+            read_byte(registers_->pc++);
         });
         result.push([this] {
             stack_.push_byte(static_cast<uint8_t>(registers_->pc >> 8u));
@@ -109,11 +343,11 @@ Pipeline Mos6502::parse_next_instruction() {
         });
         result.push([this] { stack_.push_byte(registers_->p | B_FLAG); });
         result.push([this] {
-            tmp_ = mmu_->read_byte(kBrkAddress);
+            tmp_ = read_byte(kBrkAddress);
             set_flag(I_FLAG);
         });
         result.push([this] {
-            const uint16_t pch = mmu_->read_byte(kBrkAddress + 1) << 8u;
+            const uint16_t pch = read_byte(kBrkAddress + 1) << 8u;
             registers_->pc = pch | tmp_;
         });
         break;
@@ -127,7 +361,7 @@ Pipeline Mos6502::parse_next_instruction() {
         break;
     case Instruction::PhpImplied:
         result.push([this] { /* dummy read */
-            mmu_->read_byte(registers_->pc);
+            read_byte(registers_->pc);
         });
         result.push([this] { stack_.push_byte(registers_->p | B_FLAG); });
         break;
@@ -141,7 +375,7 @@ Pipeline Mos6502::parse_next_instruction() {
                 state_.current_opcode->address_mode, memory_access));
 
         result.push([this] {
-            const uint8_t value = mmu_->read_byte(effective_address_);
+            const uint8_t value = read_byte(effective_address_);
             set_zero(value & registers_->a);
             set_negative(value);
             if (value & (1u << 6u)) {
@@ -153,7 +387,7 @@ Pipeline Mos6502::parse_next_instruction() {
         break;
     case Instruction::PlpImplied:
         result.push([this] { /* dummy read */
-            mmu_->read_byte(registers_->pc);
+            read_byte(registers_->pc);
         });
         result.push([] { /* Do nothing. */ });
         result.push([this] {
@@ -176,7 +410,7 @@ Pipeline Mos6502::parse_next_instruction() {
         result.push([this] { clear_flag(C_FLAG); });
         break;
     case Instruction::JsrAbsolute:
-        result.push([this] { tmp_ = mmu_->read_byte(registers_->pc++); });
+        result.push([this] { tmp_ = read_byte(registers_->pc++); });
         result.push([] { /* Internal operation (predecrement S?). */ });
         result.push([this] {
             const auto pch = static_cast<uint8_t>(registers_->pc >> 8u);
@@ -187,7 +421,7 @@ Pipeline Mos6502::parse_next_instruction() {
             stack_.push_byte(pcl);
         });
         result.push([this] {
-            const uint16_t pch = mmu_->read_byte(registers_->pc) << 8u;
+            const uint16_t pch = read_byte(registers_->pc) << 8u;
             registers_->pc = pch | tmp_;
         });
         break;
@@ -208,24 +442,24 @@ Pipeline Mos6502::parse_next_instruction() {
         break;
     case Instruction::PhaImplied:
         result.push([this] { /* dummy read */
-            mmu_->read_byte(registers_->pc);
+            read_byte(registers_->pc);
         });
         result.push([this] { stack_.push_byte(registers_->a); });
         break;
     case Instruction::JmpAbsolute:
-        result.push([this] { tmp_ = mmu_->read_byte(registers_->pc++); });
+        result.push([this] { tmp_ = read_byte(registers_->pc++); });
         result.push([this] {
-            const uint16_t pch = mmu_->read_byte(registers_->pc) << 8u;
+            const uint16_t pch = read_byte(registers_->pc) << 8u;
             registers_->pc = pch | tmp_;
         });
         break;
     case Instruction::JmpIndirect:
-        result.push([this] { tmp_ = mmu_->read_byte(registers_->pc++); });
-        result.push([this] { tmp2_ = mmu_->read_byte(registers_->pc++); });
+        result.push([this] { tmp_ = read_byte(registers_->pc++); });
+        result.push([this] { tmp2_ = read_byte(registers_->pc++); });
         result.push([this] {
             const uint16_t ptraddress =
                     static_cast<uint16_t>(tmp2_ << 8u) | tmp_;
-            effective_address_ = mmu_->read_byte(ptraddress);
+            effective_address_ = read_byte(ptraddress);
         });
         result.push([this] {
             // The PCH will always be fetched from the same page
@@ -233,7 +467,7 @@ Pipeline Mos6502::parse_next_instruction() {
             const uint8_t low_address = tmp_ + 1u;
             const uint16_t ptraddress =
                     static_cast<uint16_t>(tmp2_ << 8u) | low_address;
-            const uint16_t pch = mmu_->read_byte(ptraddress) << 8u;
+            const uint16_t pch = read_byte(ptraddress) << 8u;
             registers_->pc = effective_address_ | pch;
         });
         break;
@@ -276,7 +510,7 @@ Pipeline Mos6502::parse_next_instruction() {
         break;
     case Instruction::PlaImplied:
         result.push([this] { /* dummy read */
-            mmu_->read_byte(registers_->pc);
+            read_byte(registers_->pc);
         });
         result.push([] { /* Increment S, done in pop_byte(). */ });
         result.push([this] {
@@ -288,7 +522,7 @@ Pipeline Mos6502::parse_next_instruction() {
     case Instruction::RtsImplied:
         result.push([this] {
             // Dummy read
-            mmu_->read_byte(registers_->pc);
+            read_byte(registers_->pc);
         });
         result.push([] { /* Increment S, done in pop_byte(). */ });
         result.push([this] { tmp_ = stack_.pop_byte(); });
@@ -301,7 +535,7 @@ Pipeline Mos6502::parse_next_instruction() {
     case Instruction::RtiImplied:
         result.push([this] {
             // Dummy read
-            mmu_->read_byte(registers_->pc);
+            read_byte(registers_->pc);
         });
         result.push([] { /* Increment S, done in pop_byte. */ });
         result.push([this] {
@@ -604,11 +838,19 @@ Pipeline Mos6502::parse_next_instruction() {
 } // namespace n_e_s::core
 
 void Mos6502::reset() {
+    ram_ = mmu_->direct_memory(0x0000);
+    uint8_t *const open_bus = mmu_->open_bus();
+    open_bus_ = open_bus != nullptr ? open_bus : &no_open_bus_;
+    stack_.set_ram(ram_, open_bus_);
+
     pipeline_.clear();
     nmi_ = false;
+    idle_loop_.reset();
+    idle_loop_cycle_ = 0;
+    irq_inhibit_ = (registers_->p & I_FLAG) != 0;
 
-    const uint16_t lower = mmu_->read_byte(kResetAddress);
-    const uint16_t upper = mmu_->read_byte(kResetAddress + 1u) << 8u;
+    const uint16_t lower = read_byte(kResetAddress);
+    const uint16_t upper = read_byte(kResetAddress + 1u) << 8u;
     registers_->pc = upper | lower;
 }
 
@@ -620,6 +862,69 @@ void Mos6502::set_nmi(bool nmi) {
     nmi_ = nmi;
 }
 
+void Mos6502::set_irq(uint8_t sources, bool asserted) {
+    if (asserted) {
+        irq_sources_ |= sources;
+    } else {
+        irq_sources_ &= static_cast<uint8_t>(~sources);
+    }
+
+    next_scheduled_irq_ = kNotScheduled;
+    for (std::size_t i = 0; i < irq_schedule_.size(); ++i) {
+        if (sources & (1u << i)) {
+            irq_schedule_[i] = kNotScheduled;
+        }
+        next_scheduled_irq_ = std::min(next_scheduled_irq_, irq_schedule_[i]);
+    }
+}
+
+void Mos6502::schedule_irq(uint8_t sources, uint64_t cycle) {
+    for (std::size_t i = 0; i < irq_schedule_.size(); ++i) {
+        if (sources & (1u << i)) {
+            irq_schedule_[i] = cycle;
+        }
+    }
+    next_scheduled_irq_ = std::min(next_scheduled_irq_, cycle);
+}
+
+uint8_t Mos6502::irq_sources() const {
+    return irq_sources_;
+}
+
+void Mos6502::schedule_dma(std::optional<uint64_t> cycle) {
+    scheduled_dma_ = cycle.value_or(kNotScheduled);
+    // A running dma picks up the schedule when it's done.
+    if (dma_stall_cycles_ == 0) {
+        next_dma_event_ = scheduled_dma_;
+    }
+}
+
+void Mos6502::set_dma_handler(const std::function<void()> &dma_handler) {
+    dma_handler_ = dma_handler;
+}
+
+void Mos6502::set_idle_loop_detection(bool enabled) {
+    // A running loop is left at its next instruction boundary.
+    idle_loop_detection_ = enabled;
+}
+
+uint8_t Mos6502::read_byte(uint16_t addr) const {
+    if (addr < ram_.size()) {
+        *open_bus_ = ram_[addr];
+        return *open_bus_;
+    }
+    return mmu_->read_byte(addr);
+}
+
+void Mos6502::write_byte(uint16_t addr, uint8_t byte) {
+    if (addr < ram_.size()) {
+        *open_bus_ = byte;
+        ram_[addr] = byte;
+    } else {
+        mmu_->write_byte(addr, byte);
+    }
+}
+
 void Mos6502::clear_flag(uint8_t flag) {
     registers_->p &= static_cast<uint8_t>(~flag);
 }
@@ -667,13 +972,15 @@ void Mos6502::set_overflow(uint8_t reg_value,
 }
 
 Pipeline Mos6502::create_nmi() {
+    interrupted_ = true;
+
     // Dummy read
-    mmu_->read_byte(registers_->pc);
+    read_byte(registers_->pc);
     Pipeline result;
 
     result.push([this] {
         // Dummy read
-        mmu_->read_byte(registers_->pc);
+        read_byte(registers_->pc);
     });
     result.push([this] {
         stack_.push_byte(static_cast<uint8_t>(registers_->pc >> 8u));
@@ -682,9 +989,41 @@ Pipeline Mos6502::create_nmi() {
         stack_.push_byte(static_cast<uint8_t>(registers_->pc & 0xFFu));
     });
     result.push([this] { stack_.push_byte(registers_->p); });
-    result.push([this] { tmp_ = mmu_->read_byte(0xFFFA); });
+    result.push([this] { tmp_ = read_byte(0xFFFA); });
+    result.push([this] {
+        const uint16_t pch = read_byte(0xFFFB) << 8u;
+        registers_->pc = pch | tmp_;
+    });
+
+    return result;
+}
+
+Pipeline Mos6502::create_irq() {
+    interrupted_ = true;
+
+    // Dummy read
+    read_byte(registers_->pc);
+    Pipeline result;
+
+    result.push([this] {
+        // Dummy read
+        read_byte(registers_->pc);
+    });
+    result.push([this] {
+        stack_.push_byte(static_cast<uint8_t>(registers_->pc >> 8u));
+    });
+    result.push([this] {
+        stack_.push_byte(static_cast<uint8_t>(registers_->pc & 0xFFu));
+    });
+    result.push([this] {
+        stack_.push_byte(registers_->p & static_cast<uint8_t>(~B_FLAG));
+    });
+    result.push([this] {
+        tmp_ = read_byte(kIrqAddress);
+        set_flag(I_FLAG);
+    });
     result.push([this] {
-        const uint16_t pch = mmu_->read_byte(0xFFFB) << 8u;
+        const uint16_t pch = read_byte(kIrqAddress + 1) << 8u;
         registers_->pc = pch | tmp_;
     });
 
@@ -704,7 +1043,7 @@ Pipeline Mos6502::create_branch_instruction(
     });
 
     result.push_conditional([this] {
-        const uint8_t offset = mmu_->read_byte(registers_->pc++);
+        const uint8_t offset = read_byte(registers_->pc++);
         const uint16_t page = high_byte(registers_->pc);
 
         registers_->pc += to_signed(offset);
@@ -730,7 +1069,7 @@ Pipeline Mos6502::create_inc_instruction(const Opcode opcode) {
         const uint8_t new_value = tmp_ + static_cast<uint8_t>(1);
         set_zero(new_value);
         set_negative(new_value);
-        mmu_->write_byte(effective_address_, new_value);
+        write_byte(effective_address_, new_value);
     });
 
     return result;
@@ -745,7 +1084,7 @@ Pipeline Mos6502::create_dec_instruction(const Opcode opcode) {
         const uint8_t new_value = tmp_ - static_cast<uint8_t>(1);
         set_zero(new_value);
         set_negative(new_value);
-        mmu_->write_byte(effective_address_, new_value);
+        write_byte(effective_address_, new_value);
     });
 
     return result;
@@ -770,7 +1109,7 @@ Pipeline Mos6502::create_add_instruction(Opcode opcode) {
     result.append(create_addressing_steps(opcode.address_mode, memory_access));
 
     result.push([this] {
-        const uint8_t addend = mmu_->read_byte(effective_address_);
+        const uint8_t addend = read_byte(effective_address_);
         adc_impl(addend);
     });
 
@@ -786,7 +1125,7 @@ Pipeline Mos6502::create_sub_instruction(Opcode opcode) {
         // SBC simply takes the ones complement of the second value and then
         // performs an ADC See:
         // http://www.righto.com/2012/12/the-6502-overflow-flag-explained.html
-        const uint8_t addend = mmu_->read_byte(effective_address_);
+        const uint8_t addend = read_byte(effective_address_);
         adc_impl(~addend);
     });
 
@@ -803,7 +1142,7 @@ Pipeline Mos6502::create_isb_instruction(Opcode opcode) {
         const uint8_t new_value = tmp_ + static_cast<uint8_t>(1);
         set_zero(new_value);
         set_negative(new_value);
-        mmu_->write_byte(effective_address_, new_value);
+        write_byte(effective_address_, new_value);
 
         // SBC simply takes the ones complement of the second value and then
         // performs an ADC See:
@@ -821,7 +1160,7 @@ Pipeline Mos6502::create_and_instruction(Opcode opcode) {
     result.append(create_addressing_steps(opcode.address_mode, memory_access));
 
     result.push([this] {
-        const uint8_t operand = mmu_->read_byte(effective_address_);
+        const uint8_t operand = read_byte(effective_address_);
         registers_->a &= operand;
 
         set_zero(registers_->a);
@@ -849,7 +1188,7 @@ Pipeline Mos6502::create_store_instruction(Opcode opcode) {
     }
     result.push([this, reg, reg2] {
         const uint8_t value = reg2 == nullptr ? *reg : *reg & *reg2;
-        mmu_->write_byte(effective_address_, value);
+        write_byte(effective_address_, value);
     });
 
     return result;
@@ -874,7 +1213,7 @@ Pipeline Mos6502::create_load_instruction(Opcode opcode) {
     result.append(create_addressing_steps(opcode.address_mode, memory_access));
 
     result.push([this, reg, reg2] {
-        const uint8_t value = mmu_->read_byte(effective_address_);
+        const uint8_t value = read_byte(effective_address_);
         *reg = value;
         set_zero(value);
         set_negative(value);
@@ -900,7 +1239,7 @@ Pipeline Mos6502::create_compare_instruction(Opcode opcode) {
     Pipeline result;
     result.append(create_addressing_steps(opcode.address_mode, memory_access));
     result.push([this, reg] {
-        const uint8_t value = mmu_->read_byte(effective_address_);
+        const uint8_t value = read_byte(effective_address_);
         // Compare instructions are not affected be the
         // carry flag when executing the subtraction.
         const uint8_t temp_result = *reg - value;
@@ -918,7 +1257,7 @@ Pipeline Mos6502::create_dcp_instruction(Opcode opcode) {
     result.push([this] {
         // DEC
         const uint8_t new_value = tmp_ - static_cast<uint8_t>(1);
-        mmu_->write_byte(effective_address_, new_value);
+        write_byte(effective_address_, new_value);
 
         // CMP
         const uint8_t reg = registers_->a;
@@ -937,7 +1276,7 @@ Pipeline Mos6502::create_eor_instruction(Opcode opcode) {
     result.append(create_addressing_steps(opcode.address_mode, memory_access));
 
     result.push([this] {
-        const uint8_t operand = mmu_->read_byte(effective_address_);
+        const uint8_t operand = read_byte(effective_address_);
         registers_->a ^= operand;
 
         set_zero(registers_->a);
@@ -953,7 +1292,7 @@ Pipeline Mos6502::create_ora_instruction(Opcode opcode) {
     result.append(create_addressing_steps(opcode.address_mode, memory_access));
 
     result.push([this] {
-        const uint8_t operand = mmu_->read_byte(effective_address_);
+        const uint8_t operand = read_byte(effective_address_);
         registers_->a |= operand;
 
         set_zero(registers_->a);
@@ -974,7 +1313,7 @@ Pipeline Mos6502::create_slo_instruction(Opcode opcode) {
         const uint16_t temp_result = tmp_ << 1u;
         const auto result_8bit = static_cast<uint8_t>(temp_result);
         set_carry(temp_result > 0xFF);
-        mmu_->write_byte(effective_address_, result_8bit);
+        write_byte(effective_address_, result_8bit);
 
         // ORA
         registers_->a |= result_8bit;
@@ -999,7 +1338,7 @@ Pipeline Mos6502::create_rla_instruction(Opcode opcode) {
         const auto result_8bit = static_cast<uint8_t>(temp_result);
 
         set_carry(temp_result > 0xFF);
-        mmu_->write_byte(effective_address_, result_8bit);
+        write_byte(effective_address_, result_8bit);
 
         // AND
         registers_->a &= result_8bit;
@@ -1020,7 +1359,7 @@ Pipeline Mos6502::create_sre_instruction(Opcode opcode) {
         // LSR
         const uint8_t shifted_value = tmp_ >> 1u;
         set_carry(tmp_ & 0x01u);
-        mmu_->write_byte(effective_address_, shifted_value);
+        write_byte(effective_address_, shifted_value);
 
         // EOR
         registers_->a ^= shifted_value;
@@ -1045,7 +1384,7 @@ Pipeline Mos6502::create_rra_instruction(Opcode opcode) {
                                    : 0x00u;
         shifted_value |= carry;
         set_carry(tmp_ & 0x01u);
-        mmu_->write_byte(effective_address_, shifted_value);
+        write_byte(effective_address_, shifted_value);
 
         // ADC
         adc_impl(shifted_value);
@@ -1078,7 +1417,7 @@ Pipeline Mos6502::create_left_shift_instruction(Opcode opcode,
         if (opcode.address_mode == AddressMode::Accumulator) {
             registers_->a = result_8bit;
         } else {
-            mmu_->write_byte(effective_address_, result_8bit);
+            write_byte(effective_address_, result_8bit);
         }
     });
     return result;
@@ -1109,7 +1448,7 @@ Pipeline Mos6502::create_right_shift_instruction(Opcode opcode,
         if (opcode.address_mode == AddressMode::Accumulator) {
             registers_->a = shifted_value;
         } else {
-            mmu_->write_byte(effective_address_, shifted_value);
+            write_byte(effective_address_, shifted_value);
         }
     });
     return result;
@@ -1159,18 +1498,18 @@ Pipeline Mos6502::create_zeropage_addressing_steps(MemoryAccess access) {
     Pipeline result;
     if (access == MemoryAccess::Read || access == MemoryAccess::Write) {
         result.push([this] {
-            effective_address_ = mmu_->read_byte(registers_->pc);
+            effective_address_ = read_byte(registers_->pc);
             ++registers_->pc;
         });
     } else {
         result.push([this] {
-            effective_address_ = mmu_->read_byte(registers_->pc);
+            effective_address_ = read_byte(registers_->pc);
             ++registers_->pc;
         });
-        result.push([this] { tmp_ = mmu_->read_byte(effective_address_); });
+        result.push([this] { tmp_ = read_byte(effective_address_); });
         result.push([this] {
             // Extra write with the old value
-            mmu_->write_byte(effective_address_, tmp_);
+            write_byte(effective_address_, tmp_);
         });
     }
     return result;
@@ -1181,25 +1520,25 @@ Pipeline Mos6502::create_zeropage_indexed_addressing_steps(
         MemoryAccess access) {
     Pipeline result;
     if (access == MemoryAccess::Read || access == MemoryAccess::Write) {
-        result.push([this] { tmp_ = mmu_->read_byte(registers_->pc++); });
+        result.push([this] { tmp_ = read_byte(registers_->pc++); });
         result.push([this, index_reg] {
             // Dummy read
-            mmu_->read_byte(tmp_);
+            read_byte(tmp_);
             const uint8_t effective_address_low = tmp_ + *index_reg;
             effective_address_ = effective_address_low;
         });
     } else if (access == MemoryAccess::ReadWrite) {
-        result.push([this] { tmp_ = mmu_->read_byte(registers_->pc++); });
+        result.push([this] { tmp_ = read_byte(registers_->pc++); });
         result.push([this, index_reg] {
             // Dummy read
-            mmu_->read_byte(tmp_);
+            read_byte(tmp_);
             const uint8_t effective_address_low = tmp_ + *index_reg;
             effective_address_ = effective_address_low;
         });
-        result.push([this] { tmp_ = mmu_->read_byte(effective_address_); });
+        result.push([this] { tmp_ = read_byte(effective_address_); });
         result.push([this] {
             // Extra write to effective address with old value.
-            mmu_->write_byte(effective_address_, tmp_);
+            write_byte(effective_address_, tmp_);
         });
     }
     return result;
@@ -1207,16 +1546,16 @@ Pipeline Mos6502::create_zeropage_indexed_addressing_steps(
 
 Pipeline Mos6502::create_absolute_addressing_steps(const MemoryAccess access) {
     Pipeline result;
-    result.push([this] { tmp_ = mmu_->read_byte(registers_->pc++); });
+    result.push([this] { tmp_ = read_byte(registers_->pc++); });
     result.push([this] {
-        const uint16_t upper = mmu_->read_byte(registers_->pc++) << 8u;
+        const uint16_t upper = read_byte(registers_->pc++) << 8u;
         effective_address_ = upper | tmp_;
     });
     if (access == MemoryAccess::ReadWrite) {
-        result.push([this] { tmp_ = mmu_->read_byte(effective_address_); });
+        result.push([this] { tmp_ = read_byte(effective_address_); });
         result.push([this] {
             // Extra write with the old value
-            mmu_->write_byte(effective_address_, tmp_);
+            write_byte(effective_address_, tmp_);
         });
     }
     return result;
@@ -1226,9 +1565,9 @@ Pipeline Mos6502::create_absolute_indexed_addressing_steps(
         const uint8_t *index_reg,
         const MemoryAccess access) {
     Pipeline result;
-    result.push([this] { tmp_ = mmu_->read_byte(registers_->pc++); });
+    result.push([this] { tmp_ = read_byte(registers_->pc++); });
     result.push([this, index_reg] {
-        const uint16_t address_high = mmu_->read_byte(registers_->pc++) << 8u;
+        const uint16_t address_high = read_byte(registers_->pc++) << 8u;
         const uint16_t abs_address = address_high | tmp_;
         const uint8_t offset = *index_reg;
 
@@ -1242,11 +1581,11 @@ Pipeline Mos6502::create_absolute_indexed_addressing_steps(
                 // The high byte of the effective address is invalid
                 // at this time (smaller by $100), but a read is still
                 // performed.
-                mmu_->read_byte(
+                read_byte(
                         effective_address_ - static_cast<uint16_t>(0x0100));
             } else {
                 // Extra read from effective address.
-                mmu_->read_byte(effective_address_);
+                read_byte(effective_address_);
             }
         });
     } else if (access == MemoryAccess::Read) {
@@ -1255,7 +1594,7 @@ Pipeline Mos6502::create_absolute_indexed_addressing_steps(
                 // The high byte of the effective address is invalid
                 // at this time (smaller by $100), but a read is still
                 // performed.
-                mmu_->read_byte(
+                read_byte(
                         effective_address_ - static_cast<uint16_t>(0x0100));
                 return StepResult::Continue;
             }
@@ -1267,20 +1606,20 @@ Pipeline Mos6502::create_absolute_indexed_addressing_steps(
                 // The high byte of the effective address is invalid
                 // at this time (smaller by $100), but a read is still
                 // performed.
-                mmu_->read_byte(
+                read_byte(
                         effective_address_ - static_cast<uint16_t>(0x0100));
             } else {
                 // Extra read from effective address.
-                mmu_->read_byte(effective_address_);
+                read_byte(effective_address_);
             }
         });
         result.push([this] {
             // Extra read from effective address.
-            tmp_ = mmu_->read_byte(effective_address_);
+            tmp_ = read_byte(effective_address_);
         });
         result.push([this] {
             // Extra write.
-            mmu_->write_byte(effective_address_, tmp_);
+            write_byte(effective_address_, tmp_);
         });
     }
     return result;
@@ -1289,24 +1628,24 @@ Pipeline Mos6502::create_absolute_indexed_addressing_steps(
 Pipeline Mos6502::create_indexed_indirect_addressing_steps(
         const MemoryAccess access) {
     Pipeline result;
-    result.push([this] { tmp_ = mmu_->read_byte(registers_->pc++); });
+    result.push([this] { tmp_ = read_byte(registers_->pc++); });
     result.push([this] {
         // Dummy read
-        mmu_->read_byte(tmp_);
+        read_byte(tmp_);
     });
     result.push([this] {
         const uint8_t address = tmp_ + registers_->x;
-        tmp2_ = mmu_->read_byte(address);
+        tmp2_ = read_byte(address);
     });
     result.push([this] {
         // Effective address is always fetched from zero page
         const uint8_t address = tmp_ + registers_->x + 1u;
-        const uint16_t upper = mmu_->read_byte(address) << 8u;
+        const uint16_t upper = read_byte(address) << 8u;
         effective_address_ = upper | tmp2_;
     });
     if (access == MemoryAccess::ReadWrite) {
-        result.push([this] { tmp_ = mmu_->read_byte(effective_address_); });
-        result.push([this] { mmu_->write_byte(effective_address_, tmp_); });
+        result.push([this] { tmp_ = read_byte(effective_address_); });
+        result.push([this] { write_byte(effective_address_, tmp_); });
     }
     return result;
 }
@@ -1314,11 +1653,11 @@ Pipeline Mos6502::create_indexed_indirect_addressing_steps(
 Pipeline Mos6502::create_indirect_indexed_addressing_steps(
         const MemoryAccess access) {
     Pipeline result;
-    result.push([this] { tmp_ = mmu_->read_byte(registers_->pc++); });
-    result.push([this] { tmp2_ = mmu_->read_byte(tmp_); });
+    result.push([this] { tmp_ = read_byte(registers_->pc++); });
+    result.push([this] { tmp2_ = read_byte(tmp_); });
     result.push([this] {
         // The effective address is always fetched from zero page
-        const uint16_t upper = mmu_->read_byte(static_cast<uint8_t>(tmp_ + 1u))
+        const uint16_t upper = read_byte(static_cast<uint8_t>(tmp_ + 1u))
                                << 8u;
         const uint16_t address = upper | tmp2_;
         const uint8_t offset = registers_->y;
@@ -1332,11 +1671,11 @@ Pipeline Mos6502::create_indirect_indexed_addressing_steps(
                 // The high byte of the effective address is invalid
                 // at this time (smaller by $100), but a read is still
                 // performed.
-                mmu_->read_byte(
+                read_byte(
                         effective_address_ - static_cast<uint16_t>(0x0100));
             } else {
                 // Extra read from effective address.
-                mmu_->read_byte(effective_address_);
+                read_byte(effective_address_);
             }
         });
     } else if (access == MemoryAccess::Read) {
@@ -1345,7 +1684,7 @@ Pipeline Mos6502::create_indirect_indexed_addressing_steps(
                 // The high byte of the effective address is invalid
                 // at this time (smaller by $100), but a read is still
                 // performed.
-                mmu_->read_byte(
+                read_byte(
                         effective_address_ - static_cast<uint16_t>(0x0100));
                 return StepResult::Continue;
             }
@@ -1357,15 +1696,15 @@ Pipeline Mos6502::create_indirect_indexed_addressing_steps(
                 // The high byte of the effective address is invalid
                 // at this time (smaller by $100), but a read is still
                 // performed.
-                mmu_->read_byte(
+                read_byte(
                         effective_address_ - static_cast<uint16_t>(0x0100));
             } else {
                 // Extra read from effective address.
-                mmu_->read_byte(effective_address_);
+                read_byte(effective_address_);
             }
         });
-        result.push([this] { tmp_ = mmu_->read_byte(effective_address_); });
-        result.push([this] { mmu_->write_byte(effective_address_, tmp_); });
+        result.push([this] { tmp_ = read_byte(effective_address_); });
+        result.push([this] { write_byte(effective_address_, tmp_); });
     }
     return result;
 }
@@ -5,7 +5,11 @@
 #include "nes/core/opcode.h"
 #include "pipeline.h"
 
+#include <array>
 #include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
 
 namespace n_e_s::core {
 
@@ -23,6 +27,15 @@ public:
 
     void set_nmi(bool nmi) override;
 
+    void set_irq(uint8_t sources, bool asserted) override;
+    void schedule_irq(uint8_t sources, uint64_t cycle) override;
+    uint8_t irq_sources() const override;
+
+    void schedule_dma(std::optional<uint64_t> cycle) override;
+    void set_dma_handler(const std::function<void()> &dma_handler) override;
+
+    void set_idle_loop_detection(bool enabled) override;
+
 private:
     CpuRegisters *const registers_;
     IMmu *const mmu_;
@@ -34,6 +47,9 @@ private:
     public:
         Stack(CpuRegisters *registers, IMmu *mmu);
 
+        // Accesses the stack page directly if the ram covers it.
+        void set_ram(std::span<uint8_t> ram, uint8_t *open_bus);
+
         uint8_t pop_byte();
         void push_byte(uint8_t byte);
 
@@ -41,8 +57,18 @@ private:
         CpuRegisters *const registers_;
         IMmu *const mmu_;
         const uint16_t ram_offset_{0x0100};
+        uint8_t *page_{nullptr};
+        uint8_t *open_bus_{nullptr};
     };
 
+    // Memory starting at address 0 that the mmu lets us access directly.
+    // Mostly zeropage and the stack, and empty when testing with mocks.
+    std::span<uint8_t> ram_;
+    // Direct accesses update the mmu's open bus latch, or a dummy if it has
+    // none.
+    uint8_t *open_bus_{&no_open_bus_};
+    uint8_t no_open_bus_{};
+
     Stack stack_;
 
     CpuState state_;
@@ -50,6 +76,48 @@ private:
     // Set to true if a nmi interrupt should be exectued.
     bool nmi_{false};
 
+    // Bitmask of the IrqSources asserting the irq line.
+    uint8_t irq_sources_{};
+    // The cycle each IrqSource bit is scheduled to assert the line at.
+    static constexpr uint64_t kNotScheduled{UINT64_MAX};
+    std::array<uint64_t, 8> irq_schedule_{};
+    uint64_t next_scheduled_irq_{kNotScheduled};
+    // The I flag as it was before the last executed cycle.
+    bool irq_inhibit_{true};
+
+    // The cycle the next dmc dma starts at. While a dma stalls the cpu it's
+    // the next cycle, so that the common case of no dma costs one compare.
+    uint64_t next_dma_event_{kNotScheduled};
+    uint64_t scheduled_dma_{kNotScheduled};
+    uint8_t dma_stall_cycles_{};
+    std::function<void()> dma_handler_{[] {}};
+
+    static constexpr const char *kInstructionTrace{"Mos6502 instruction"};
+    // If a trace scope is open for the instruction being executed.
+    bool instruction_traced_{false};
+
+    // A loop that only reads the cpu registers and at most one address. While
+    // one is running, the cpu steps through it without building pipelines.
+    struct IdleLoop {
+        Opcode load; // The jump itself for jump loops.
+        uint16_t load_pc;
+        uint16_t address; // Address polled by the load.
+        Opcode branch;
+        uint16_t branch_pc;
+        uint8_t load_cycles;
+        uint8_t period; // Cycles per iteration.
+        bool polls_address;
+    };
+
+    bool idle_loop_detection_{true};
+    std::optional<IdleLoop> idle_loop_;
+    uint8_t idle_loop_cycle_{};
+
+    // The instruction decoded before state_.current_opcode.
+    CpuState previous_state_;
+    // Set when an interrupt sequence ran after the last decoded instruction.
+    bool interrupted_{false};
+
     // Holds the atoms staged to be executed.
     Pipeline pipeline_{};
 
@@ -65,6 +133,10 @@ private:
     // crossing.
     bool is_crossing_page_boundary_{false};
 
+    // Accesses ram_ directly and everything else through the mmu.
+    uint8_t read_byte(uint16_t addr) const;
+    void write_byte(uint16_t addr, uint8_t byte);
+
     void clear_flag(uint8_t flag);
     void set_flag(uint8_t flag);
 
@@ -85,7 +157,36 @@ private:
 
     Pipeline parse_next_instruction();
 
+    // Returns true if an irq should be taken at the next instruction boundary.
+    bool irq_pending();
+
+    // Returns true if an interrupt should be taken at the next instruction
+    // boundary.
+    bool interrupt_pending();
+
+    // Asserts the irq line for all sources scheduled at or before now.
+    void assert_scheduled_irqs();
+
+    // Ends the trace scope of the last instruction and begins one for the
+    // next if tracing is enabled.
+    void trace_instruction();
+
+    // Runs one cycle of a dmc dma.
+    void execute_dma();
+
+    // Checks if the last two decoded instructions form an idle loop that is
+    // about to start over.
+    std::optional<IdleLoop> find_idle_loop() const;
+
+    // Runs one cycle of the current idle loop. Returns false, without using
+    // the cycle, if the loop is left and normal execution should continue.
+    bool execute_idle_loop();
+
+    // Returns true if the condition of the branch instruction holds.
+    bool is_branch_taken(Family family) const;
+
     Pipeline create_nmi();
+    Pipeline create_irq();
     Pipeline create_branch_instruction(const std::function<bool()> &condition);
     Pipeline create_inc_instruction(Opcode opcode);
     Pipeline create_dec_instruction(Opcode opcode);
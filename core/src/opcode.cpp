@@ -143,4 +143,38 @@ std::string_view to_string(const Family family) {
     throw std::logic_error("Unknown family"); // GCOVR_EXCL_LINE
 }
 
+std::string_view to_string(const AddressMode address_mode) {
+    switch (address_mode) {
+    case AddressMode::Implied:
+        return "Implied";
+    case AddressMode::Immediate:
+        return "Immediate";
+    case AddressMode::Zeropage:
+        return "Zeropage";
+    case AddressMode::ZeropageX:
+        return "ZeropageX";
+    case AddressMode::ZeropageY:
+        return "ZeropageY";
+    case AddressMode::Relative:
+        return "Relative";
+    case AddressMode::Absolute:
+        return "Absolute";
+    case AddressMode::AbsoluteX:
+        return "AbsoluteX";
+    case AddressMode::AbsoluteY:
+        return "AbsoluteY";
+    case AddressMode::Accumulator:
+        return "Accumulator";
+    case AddressMode::IndexedIndirect:
+        return "IndexedIndirect";
+    case AddressMode::IndirectIndexed:
+        return "IndirectIndexed";
+    case AddressMode::Indirect:
+        return "Indirect";
+    }
+
+    // Should not happen
+    throw std::logic_error("Unknown address mode"); // GCOVR_EXCL_LINE
+}
+
 } // namespace n_e_s::core
@@ -5,6 +5,7 @@
 
 #include "nes/core/invalid_address.h"
 #include "nes/core/pixel.h"
+#include "nes/core/trace.h"
 
 namespace {
 
@@ -95,12 +96,8 @@ const uint16_t kPpuData = 0x2007;
 const uint16_t kFirstPaletteData = 0x3F00;
 
 const uint16_t kLastCycleInScanline = 340;
-const uint16_t kLastScanlineInFrame = 261;
-const uint16_t kPreRenderScanline = 261;
 const uint16_t kVisibleScanlineEnd = 239;
 const uint16_t kPostRenderScanline = 240;
-const uint16_t kVBlankScanlineStart = 241;
-const uint16_t kVBlankScanlineEnd = 260;
 
 // From
 // https://wiki.nesdev.org/w/index.php/PPU_scrolling#Tile_and_attribute_fetching
@@ -120,10 +117,12 @@ constexpr uint16_t get_attribute_address(uint16_t vram_addr) {
 
 namespace n_e_s::core {
 
-Ppu::Ppu(PpuRegisters *registers, IMmu *mmu)
+template <typename Region>
+Ppu<Region>::Ppu(PpuRegisters *registers, IMmu *mmu)
         : registers_(registers), mmu_(mmu) {}
 
-uint8_t Ppu::read_byte(uint16_t addr) {
+template <typename Region>
+uint8_t Ppu<Region>::read_byte(uint16_t addr) {
     uint8_t byte = open_bus_;
 
     if (addr == kPpuCtrl || addr == kPpuMask || addr == kOamAddr ||
@@ -161,7 +160,8 @@ uint8_t Ppu::read_byte(uint16_t addr) {
     return byte;
 }
 
-void Ppu::write_byte(uint16_t addr, uint8_t byte) {
+template <typename Region>
+void Ppu<Region>::write_byte(uint16_t addr, uint8_t byte) {
     if (addr == kPpuCtrl) {
         open_bus_ = byte;
         const auto new_ctrl = PpuCtrl(byte);
@@ -225,7 +225,17 @@ void Ppu::write_byte(uint16_t addr, uint8_t byte) {
     }
 } // namespace n_e_s::core
 
-std::optional<Pixel> Ppu::execute() {
+template <typename Region>
+std::optional<Pixel> Ppu<Region>::execute() {
+    if (Trace::enabled()) {
+        trace_scanline_phase();
+    } else if (trace_phase_ != nullptr) {
+        // Tracing was turned off, so close the phase while its begin is
+        // still in the trace.
+        Trace::end(trace_phase_);
+        trace_phase_ = nullptr;
+    }
+
     std::optional<Pixel> pixel;
 
     if (is_pre_render_scanline()) {
@@ -242,31 +252,63 @@ std::optional<Pixel> Ppu::execute() {
     return pixel;
 }
 
-void Ppu::set_nmi_handler(const std::function<void()> &on_nmi) {
+template <typename Region>
+void Ppu<Region>::trace_scanline_phase() {
+    const char *phase = "Ppu vblank";
+    if (is_pre_render_scanline()) {
+        phase = "Ppu pre-render";
+    } else if (is_visible_scanline()) {
+        phase = "Ppu visible";
+    } else if (is_post_render_scanline()) {
+        phase = "Ppu post-render";
+    }
+
+    if (phase != trace_phase_) {
+        if (trace_phase_ != nullptr) {
+            Trace::end(trace_phase_);
+        }
+        Trace::begin(phase);
+        trace_phase_ = phase;
+    }
+}
+
+template <typename Region>
+void Ppu<Region>::set_nmi_handler(const std::function<void()> &on_nmi) {
     on_nmi_ = on_nmi;
 }
-uint16_t Ppu::scanline() const {
+template <typename Region>
+void Ppu<Region>::set_a12_rise_handler(
+        const std::function<void()> &on_a12_rise) {
+    on_a12_rise_ = on_a12_rise;
+}
+
+template <typename Region>
+uint16_t Ppu<Region>::scanline() const {
     return registers_->scanline;
 }
 
-uint16_t Ppu::cycle() const {
+template <typename Region>
+uint16_t Ppu<Region>::cycle() const {
     return registers_->cycle;
 }
-uint16_t &Ppu::scanline() {
+template <typename Region>
+uint16_t &Ppu<Region>::scanline() {
     return registers_->scanline;
 }
 
-uint16_t &Ppu::cycle() {
+template <typename Region>
+uint16_t &Ppu<Region>::cycle() {
     return registers_->cycle;
 }
 
-void Ppu::update_counters() {
+template <typename Region>
+void Ppu<Region>::update_counters() {
     if (cycle() == kLastCycleInScanline) {
         cycle() = 0;
         if (scanline() == kLastScanlineInFrame) {
             scanline() = 0;
             registers_->odd_frame = !registers_->odd_frame;
-            if (registers_->odd_frame &&
+            if (Region::kSkipsDotOnOddFrames && registers_->odd_frame &&
                     registers_->mask.is_rendering_enabled()) {
                 cycle() = 1;
             }
@@ -278,30 +320,37 @@ void Ppu::update_counters() {
     }
 }
 
-bool Ppu::is_pre_render_scanline() const {
+template <typename Region>
+bool Ppu<Region>::is_pre_render_scanline() const {
     return scanline() == kPreRenderScanline;
 }
 
-bool Ppu::is_visible_scanline() const {
+template <typename Region>
+bool Ppu<Region>::is_visible_scanline() const {
     // Visible scanlines starts at 0
     return scanline() <= kVisibleScanlineEnd;
 }
 
-bool Ppu::is_post_render_scanline() const {
-    return scanline() == kPostRenderScanline;
+template <typename Region>
+bool Ppu<Region>::is_post_render_scanline() const {
+    return scanline() >= kPostRenderScanline &&
+           scanline() < kVBlankScanlineStart;
 }
 
-bool Ppu::is_vblank_scanline() const {
+template <typename Region>
+bool Ppu<Region>::is_vblank_scanline() const {
     return scanline() >= kVBlankScanlineStart &&
            scanline() <= kVBlankScanlineEnd;
 }
 
-bool Ppu::is_rendering_active() const {
+template <typename Region>
+bool Ppu<Region>::is_rendering_active() const {
     return registers_->mask.is_rendering_enabled() &&
            (is_pre_render_scanline() || is_visible_scanline());
 }
 
-uint8_t Ppu::get_vram_address_increment() const {
+template <typename Region>
+uint8_t Ppu<Region>::get_vram_address_increment() const {
     uint8_t addr_increment = 1u;
 
     if (registers_->ctrl.is_set(2u)) {
@@ -311,31 +360,38 @@ uint8_t Ppu::get_vram_address_increment() const {
     return addr_increment;
 }
 
-void Ppu::increment_vram_address() {
+template <typename Region>
+void Ppu<Region>::increment_vram_address() {
     registers_->vram_addr = PpuVram(
             registers_->vram_addr.value() + get_vram_address_increment());
 }
 
-void Ppu::execute_pre_render_scanline() {
+template <typename Region>
+void Ppu<Region>::execute_pre_render_scanline() {
     fetch();
+    notify_a12_rise();
     increase_scroll_counters();
     if (cycle() == 1) {
         clear_vblank_flag();
     }
 }
 
-std::optional<Pixel> Ppu::execute_visible_scanline() {
+template <typename Region>
+std::optional<Pixel> Ppu<Region>::execute_visible_scanline() {
     fetch();
+    notify_a12_rise();
     increase_scroll_counters();
     return pixel();
 }
 
-void Ppu::execute_post_render_scanline() {
+template <typename Region>
+void Ppu<Region>::execute_post_render_scanline() {
     // The ppu is idle this scanline
 }
 
-void Ppu::execute_vblank_scanline() {
-    if (scanline() == 241 && cycle() == 1) {
+template <typename Region>
+void Ppu<Region>::execute_vblank_scanline() {
+    if (scanline() == kVBlankScanlineStart && cycle() == 1) {
         set_vblank_flag();
         if (registers_->ctrl.is_set(7u)) {
             on_nmi_();
@@ -343,15 +399,18 @@ void Ppu::execute_vblank_scanline() {
     }
 }
 
-void Ppu::set_vblank_flag() {
+template <typename Region>
+void Ppu<Region>::set_vblank_flag() {
     registers_->status.set_bit(7u);
 }
 
-void Ppu::clear_vblank_flag() {
+template <typename Region>
+void Ppu<Region>::clear_vblank_flag() {
     registers_->status.clear_bit(7u);
 }
 
-void Ppu::shift_registers() {
+template <typename Region>
+void Ppu<Region>::shift_registers() {
     registers_->pattern_table_shifter_low <<= 1u;
     registers_->pattern_table_shifter_hi <<= 1u;
 
@@ -359,7 +418,8 @@ void Ppu::shift_registers() {
     registers_->attribute_table_shifter_hi <<= 1u;
 }
 
-void Ppu::increase_scroll_counters() {
+template <typename Region>
+void Ppu<Region>::increase_scroll_counters() {
     if (!registers_->mask.is_rendering_enabled()) {
         return;
     }
@@ -395,7 +455,8 @@ void Ppu::increase_scroll_counters() {
         registers_->vram_addr = PpuVram(addr);
     }
 }
-void Ppu::fetch() {
+template <typename Region>
+void Ppu<Region>::fetch() {
     if ((cycle() >= 1 && cycle() <= 256) ||
             (cycle() >= 321 && cycle() <= 336)) {
         shift_registers();
@@ -478,7 +539,35 @@ void Ppu::fetch() {
     }
 }
 
-std::optional<Pixel> Ppu::pixel() {
+template <typename Region>
+void Ppu<Region>::notify_a12_rise() {
+    // Background patterns are fetched during cycles 1-256 and 321-336 and
+    // sprite patterns during 257-320, so A12 rises once per scanline if they
+    // use different pattern tables. The short drops for nametable fetches in
+    // between are too short for the mmc3 to count. Unused sprite slots fetch
+    // tile $FF, which is in the $1000 table in 8x16 mode.
+    if (cycle() != 260 && cycle() != 324) {
+        return;
+    }
+    if (!registers_->mask.is_rendering_enabled()) {
+        return;
+    }
+
+    const bool background_high = registers_->ctrl.is_set(4u);
+    const bool sprites_high =
+            registers_->ctrl.is_set(5u) || registers_->ctrl.is_set(3u);
+    if (background_high == sprites_high) {
+        return;
+    }
+
+    const uint16_t rise_cycle = sprites_high ? 260 : 324;
+    if (cycle() == rise_cycle) {
+        on_a12_rise_();
+    }
+}
+
+template <typename Region>
+std::optional<Pixel> Ppu<Region>::pixel() {
     const bool visible_cycle = cycle() >= 1u && cycle() <= 256u;
     if (!visible_cycle) {
         return std::nullopt;
@@ -532,8 +621,13 @@ std::optional<Pixel> Ppu::pixel() {
     return Pixel{.x = x, .y = y, .color = color};
 }
 
-Color Ppu::get_color_from_palette_index(uint8_t index) const {
+template <typename Region>
+Color Ppu<Region>::get_color_from_palette_index(uint8_t index) const {
     return kPalette[index % kPalette.size()];
 }
 
+template class Ppu<Ntsc>;
+template class Ppu<Pal>;
+template class Ppu<Dendy>;
+
 } // namespace n_e_s::core
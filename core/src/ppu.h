@@ -2,11 +2,13 @@
 
 #include "nes/core/immu.h"
 #include "nes/core/ippu.h"
+#include "nes/core/region.h"
 
 #include <memory>
 
 namespace n_e_s::core {
 
+template <typename Region>
 class Ppu final : public IPpu {
 public:
     explicit Ppu(PpuRegisters *registers, IMmu *mmu);
@@ -17,11 +19,22 @@ public:
     std::optional<Pixel> execute() override;
 
     void set_nmi_handler(const std::function<void()> &on_nmi) override;
+    void set_a12_rise_handler(
+            const std::function<void()> &on_a12_rise) override;
 
     uint16_t scanline() const override;
     uint16_t cycle() const override;
 
 private:
+    // The visible scanlines and the first idle one are the same everywhere,
+    // but the rest of the frame differs between regions.
+    static constexpr uint16_t kVBlankScanlineStart{
+            240 + Region::kPostRenderScanlines};
+    static constexpr uint16_t kVBlankScanlineEnd{
+            kVBlankScanlineStart + Region::kVBlankScanlines - 1};
+    static constexpr uint16_t kPreRenderScanline{kVBlankScanlineEnd + 1};
+    static constexpr uint16_t kLastScanlineInFrame{kPreRenderScanline};
+
     uint16_t &scanline();
     uint16_t &cycle();
 
@@ -29,6 +42,10 @@ private:
     IMmu *const mmu_;
 
     std::function<void()> on_nmi_{[] {}};
+    std::function<void()> on_a12_rise_{[] {}};
+
+    // The scanline phase currently open in the trace, if any.
+    const char *trace_phase_{nullptr};
 
     uint8_t read_buffer_{0};
     uint8_t open_bus_{0};
@@ -58,6 +75,9 @@ private:
     // from/to the VRAM.
     void increment_vram_address();
 
+    // Begins a new trace event when entering a new scanline phase.
+    void trace_scanline_phase();
+
     void execute_pre_render_scanline();
     std::optional<Pixel> execute_visible_scanline();
     void execute_post_render_scanline();
@@ -69,6 +89,7 @@ private:
     void shift_registers();
     void increase_scroll_counters();
     void fetch();
+    void notify_a12_rise();
     std::optional<Pixel> pixel();
 
     Color get_color_from_palette_index(uint8_t index) const;
@@ -4,8 +4,19 @@
 
 namespace n_e_s::core {
 
-std::unique_ptr<IPpu> PpuFactory::create(PpuRegisters *registers, IMmu *mmu) {
-    return std::make_unique<Ppu>(registers, mmu);
+std::unique_ptr<IPpu> PpuFactory::create(PpuRegisters *registers,
+        IMmu *mmu,
+        Timing timing) {
+    switch (timing) {
+    case Timing::Pal:
+        return std::make_unique<Ppu<Pal>>(registers, mmu);
+    case Timing::Dendy:
+        return std::make_unique<Ppu<Dendy>>(registers, mmu);
+    case Timing::Ntsc:
+    case Timing::MultiRegion:
+        break;
+    }
+    return std::make_unique<Ppu<Ntsc>>(registers, mmu);
 }
 
 } // namespace n_e_s::core
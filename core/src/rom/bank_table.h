@@ -0,0 +1,76 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+namespace n_e_s::core {
+
+// Maps an address window onto banks of host memory through a table of
+// pointers to PageSize sized pages. The table is only updated when a mapper
+// switches banks, so reading is a shift, a load and an add.
+template <uint16_t WindowStart, std::size_t PageSize, std::size_t PageCount>
+class BankTable {
+public:
+    static_assert(std::has_single_bit(PageSize), "PageSize must be 2^n");
+    static_assert(WindowStart % PageSize == 0, "Window must be aligned");
+
+    static constexpr std::size_t kWindowSize{PageSize * PageCount};
+
+    // Maps page_count pages starting at first_page to memory starting at
+    // offset. Offsets past the end of memory wrap around like they do on
+    // boards with less memory than the bank registers can address.
+    void map(std::size_t first_page,
+            std::size_t page_count,
+            std::span<const uint8_t> memory,
+            std::size_t offset) {
+        for (std::size_t i = 0; i < page_count; ++i) {
+            const std::size_t page_offset =
+                    (offset + i * PageSize) % memory.size();
+            pages_[first_page + i] = memory.data() + page_offset;
+            offsets_[first_page + i] = page_offset;
+        }
+    }
+
+    [[nodiscard]] uint8_t read(uint16_t addr) const {
+        const std::size_t window_addr = addr - WindowStart;
+        return pages_[window_addr / PageSize][window_addr % PageSize];
+    }
+
+    // The offset into the mapped memory that addr reads from.
+    [[nodiscard]] std::size_t offset(uint16_t addr) const {
+        const std::size_t window_addr = addr - WindowStart;
+        return offsets_[window_addr / PageSize] + window_addr % PageSize;
+    }
+
+    // Reads addr and the addresses following it, which must all be inside
+    // the window.
+    void read_block(uint16_t addr, std::span<uint8_t> dst) const {
+        std::size_t window_addr = addr - WindowStart;
+        while (!dst.empty()) {
+            const std::size_t in_page = window_addr % PageSize;
+            const std::size_t count =
+                    std::min(dst.size(), PageSize - in_page);
+            std::memcpy(dst.data(),
+                    pages_[window_addr / PageSize] + in_page,
+                    count);
+            dst = dst.subspan(count);
+            window_addr += count;
+        }
+    }
+
+private:
+    std::array<const uint8_t *, PageCount> pages_{};
+    std::array<std::size_t, PageCount> offsets_{};
+};
+
+// 8 KB prg rom banks at $8000-$FFFF.
+using PrgBankTable = BankTable<0x8000, 0x2000, 4>;
+// 1 KB chr banks at $0000-$1FFF.
+using ChrBankTable = BankTable<0x0000, 0x0400, 8>;
+
+} // namespace n_e_s::core
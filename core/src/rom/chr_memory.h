@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace n_e_s::core {
+
+// Chr rom is read straight out of the shared rom image while boards without
+// chr rom get their own chr ram, 8 KB unless the header says otherwise. Chr
+// rom is copied on the first write to it so that the shared image is never
+// modified.
+class ChrMemory {
+public:
+    ChrMemory(std::span<const uint8_t> chr_rom, std::size_t ram_size)
+            : memory_(chr_rom) {
+        if (memory_.empty()) {
+            ram_.resize(ram_size != 0 ? ram_size : kChrRamSize);
+            memory_ = ram_;
+        }
+    }
+
+    ChrMemory(const ChrMemory &) = delete;
+    ChrMemory &operator=(const ChrMemory &) = delete;
+
+    uint8_t operator[](std::size_t addr) const {
+        return memory_[addr];
+    }
+
+    // Returns true if the memory moved, in which case anything pointing
+    // into bytes() has to be updated.
+    [[nodiscard]] bool write(std::size_t addr, uint8_t byte) {
+        const bool copy = ram_.empty();
+        if (copy) {
+            ram_.assign(memory_.begin(), memory_.end());
+            memory_ = ram_;
+        }
+        ram_[addr] = byte;
+        return copy;
+    }
+
+    [[nodiscard]] std::span<const uint8_t> bytes() const {
+        return memory_;
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        return memory_.size();
+    }
+
+private:
+    static constexpr std::size_t kChrRamSize{8u * 1024u};
+
+    std::span<const uint8_t> memory_;
+    std::vector<uint8_t> ram_;
+};
+
+} // namespace n_e_s::core
@@ -0,0 +1,188 @@
+#include "rom/mapper_1.h"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <utility>
+#include "nes/core/ines_header.h"
+#include "nes/core/trace.h"
+
+namespace n_e_s::core {
+
+Mapper1::Mapper1(const RomImage &image, PrgRam prg_ram)
+        : IRom(image.header),
+          rom_storage_(image.storage),
+          prg_rom_(image.prg_rom),
+          chr_mem_(image.chr_rom, image.header.chr_ram_bytes()),
+          prg_ram_(std::move(prg_ram)),
+          nametables_(Mirroring::SingleScreenLower) {
+    if (prg_rom_.empty()) {
+        throw std::invalid_argument("Invalid prg_rom size");
+    }
+
+    update_prg_banks();
+    update_chr_banks();
+    update_mirroring();
+}
+
+bool Mapper1::is_cpu_address_in_range(uint16_t addr) const {
+    const bool in_prg = addr >= kPrgRamStart;
+    return in_prg;
+}
+
+uint8_t Mapper1::cpu_read_byte(uint16_t addr) const {
+    // The prg ram enable bit isn't implemented since the MMC1A doesn't have
+    // it and games working on both revisions don't depend on it.
+    if (addr <= kPrgRamEnd) {
+        return prg_ram_.read(addr - kPrgRamStart);
+    }
+
+    return prg_banks_.read(addr);
+}
+
+void Mapper1::cpu_write_byte(uint16_t addr, uint8_t byte) {
+    if (addr <= kPrgRamEnd) {
+        prg_ram_.write(addr - kPrgRamStart, byte);
+        return;
+    }
+
+    // Writing a byte with bit 7 set resets the shift register and sets prg
+    // mode 3.
+    if (byte & 0x80u) {
+        shift_register_ = 0;
+        shift_count_ = 0;
+        control_ |= 0x0Cu;
+        update_prg_banks();
+        return;
+    }
+
+    // Bits are shifted in lsb first, the fifth write selects the register
+    // using bits 13 and 14 of the address.
+    shift_register_ |= static_cast<uint8_t>((byte & 0x01u) << shift_count_);
+    if (++shift_count_ == 5) {
+        write_register(addr, shift_register_);
+        shift_register_ = 0;
+        shift_count_ = 0;
+    }
+}
+
+void Mapper1::cpu_read_block(uint16_t addr, std::span<uint8_t> dst) const {
+    if (addr <= kPrgRamEnd) {
+        const auto ram_count = std::min<std::size_t>(
+                dst.size(), kPrgRomStart - addr);
+        prg_ram_.read_block(addr - kPrgRamStart, dst.first(ram_count));
+        dst = dst.subspan(ram_count);
+        addr = kPrgRomStart;
+    }
+
+    if (!dst.empty()) {
+        prg_banks_.read_block(addr, dst);
+    }
+}
+
+bool Mapper1::is_ppu_address_in_range(uint16_t addr) const {
+    const bool in_chr = addr <= kChrEnd;
+    const bool in_nametable = addr >= kNametableStart && addr <= kNametableEnd;
+    return in_chr || in_nametable;
+}
+
+uint8_t Mapper1::ppu_read_byte(uint16_t addr) const {
+    if (addr <= kChrEnd) {
+        return chr_banks_.read(addr);
+    }
+    return nametables_.read(addr);
+}
+
+void Mapper1::ppu_write_byte(uint16_t addr, uint8_t byte) {
+    if (addr <= kChrEnd) {
+        if (chr_mem_.write(chr_banks_.offset(addr), byte)) {
+            update_chr_banks();
+        }
+    } else {
+        nametables_.write(addr, byte);
+    }
+}
+
+void Mapper1::write_register(uint16_t addr, uint8_t value) {
+    if (Trace::enabled()) {
+        Trace::instant("Mapper1 bank switch");
+    }
+
+    switch ((addr >> 13u) & 0x03u) {
+    case 0: // $8000-$9FFF
+        control_ = value;
+        update_prg_banks();
+        update_chr_banks();
+        update_mirroring();
+        break;
+    case 1: // $A000-$BFFF
+        chr_bank_0_ = value;
+        update_prg_banks();
+        update_chr_banks();
+        break;
+    case 2: // $C000-$DFFF
+        chr_bank_1_ = value;
+        update_chr_banks();
+        break;
+    case 3: // $E000-$FFFF
+        prg_bank_ = value;
+        update_prg_banks();
+        break;
+    }
+}
+
+void Mapper1::update_prg_banks() {
+    // The prg bank only reaches 256 KB. SUROM and SXROM boards have 512 KB
+    // and use bit 4 of the first chr bank to select the 256 KB half all prg
+    // banks, fixed ones included, are in. That bit would have to come from
+    // the chr bank the ppu is using in 4 KB chr mode, but games set both
+    // chr banks the same, so the first one is used.
+    const std::size_t outer =
+            prg_rom_.size() > kPrgOuterBankSize && (chr_bank_0_ & 0x10u)
+                    ? kPrgOuterBankSize
+                    : 0;
+    const std::size_t last =
+            std::min(prg_rom_.size(), kPrgOuterBankSize) - kPrgBankSize;
+    const std::size_t bank = outer + (prg_bank_ & 0x0Fu) * kPrgBankSize;
+    switch ((control_ >> 2u) & 0x03u) {
+    case 0:
+    case 1:
+        // Switch 32 KB at $8000, ignoring the low bit of the bank number.
+        prg_banks_.map(0, 4, prg_rom_, bank & ~kPrgBankSize);
+        break;
+    case 2:
+        // Fix the first bank at $8000 and switch 16 KB at $C000.
+        prg_banks_.map(0, 2, prg_rom_, outer);
+        prg_banks_.map(2, 2, prg_rom_, bank);
+        break;
+    case 3:
+        // Fix the last bank at $C000 and switch 16 KB at $8000.
+        prg_banks_.map(0, 2, prg_rom_, bank);
+        prg_banks_.map(2, 2, prg_rom_, outer + last);
+        break;
+    }
+}
+
+void Mapper1::update_chr_banks() {
+    const std::span<const uint8_t> chr = chr_mem_.bytes();
+    if (control_ & 0x10u) {
+        // Two separate 4 KB banks.
+        chr_banks_.map(0, 4, chr, chr_bank_0_ * kChrBankSize);
+        chr_banks_.map(4, 4, chr, chr_bank_1_ * kChrBankSize);
+    } else {
+        // One 8 KB bank, ignoring the low bit of the bank number.
+        chr_banks_.map(0, 8, chr, (chr_bank_0_ & 0x1Eu) * kChrBankSize);
+    }
+}
+
+void Mapper1::update_mirroring() {
+    constexpr std::array<Mirroring, 4> kMirroring{
+            Mirroring::SingleScreenLower,
+            Mirroring::SingleScreenUpper,
+            Mirroring::Vertical,
+            Mirroring::Horizontal,
+    };
+    nametables_.set_mirroring(kMirroring[control_ & 0x03u]);
+}
+
+} // namespace n_e_s::core
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "nes/core/irom.h"
+#include "rom/bank_table.h"
+#include "rom/chr_memory.h"
+#include "rom/nametables.h"
+#include "rom/prg_ram.h"
+#include "rom/rom_image.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+namespace n_e_s::core {
+
+// MMC1, https://www.nesdev.org/wiki/MMC1
+class Mapper1 : public IRom {
+public:
+    Mapper1(const RomImage &image, PrgRam prg_ram);
+
+    [[nodiscard]] bool is_cpu_address_in_range(uint16_t addr) const override;
+    uint8_t cpu_read_byte(uint16_t addr) const override;
+    void cpu_write_byte(uint16_t addr, uint8_t byte) override;
+    void cpu_read_block(uint16_t addr,
+            std::span<uint8_t> dst) const override;
+
+    [[nodiscard]] bool is_ppu_address_in_range(uint16_t addr) const override;
+    uint8_t ppu_read_byte(uint16_t addr) const override;
+    void ppu_write_byte(uint16_t addr, uint8_t byte) override;
+
+private:
+    void write_register(uint16_t addr, uint8_t value);
+    void update_prg_banks();
+    void update_chr_banks();
+    void update_mirroring();
+
+    // Registers are written one bit at a time through the shift register.
+    uint8_t shift_register_{0u};
+    uint8_t shift_count_{0u};
+
+    // Power on in prg mode 3, fixing the last bank at $C000.
+    uint8_t control_{0x0Cu};
+    uint8_t chr_bank_0_{0u};
+    uint8_t chr_bank_1_{0u};
+    uint8_t prg_bank_{0u};
+
+    std::shared_ptr<const void> rom_storage_;
+    std::span<const uint8_t> prg_rom_;
+    ChrMemory chr_mem_;
+    PrgRam prg_ram_;
+
+    PrgBankTable prg_banks_;
+    ChrBankTable chr_banks_;
+
+    Nametables nametables_;
+
+    constexpr static uint16_t kChrEnd{0x1FFF};
+    constexpr static uint16_t kNametableStart{0x2000};
+    constexpr static uint16_t kNametableEnd{0x3EFF};
+
+    constexpr static uint16_t kPrgRamStart{0x6000};
+    constexpr static uint16_t kPrgRamEnd{0x7FFF};
+    constexpr static uint16_t kPrgRomStart{0x8000};
+
+    constexpr static std::size_t kPrgBankSize{0x4000};
+    constexpr static std::size_t kPrgOuterBankSize{0x40000};
+    constexpr static std::size_t kChrBankSize{0x1000};
+};
+
+} // namespace n_e_s::core
@@ -2,57 +2,61 @@
 
 #include <cstddef>
 #include <stdexcept>
-#include <string>
 #include "nes/core/ines_header.h"
-#include "nes/core/invalid_address.h"
+#include "nes/core/trace.h"
 
 namespace n_e_s::core {
 
-Mapper2::Mapper2(const INesHeader &h,
-        std::vector<uint8_t> prg_rom,
-        std::vector<uint8_t> chr_mem)
-        : IRom(h),
-          select_bank_hi_(h.prg_rom_size - 1),
-          prg_rom_(std::move(prg_rom)),
-          chr_mem_(std::move(chr_mem)),
-          nametables_{} {
-    if (prg_rom_.size() !=
-            static_cast<std::size_t>(16u * 1024u * h.prg_rom_size)) {
+Mapper2::Mapper2(const RomImage &image)
+        : IRom(image.header),
+          select_bank_hi_(image.header.prg_rom_size - 1),
+          rom_storage_(image.storage),
+          prg_rom_(image.prg_rom),
+          chr_mem_(image.chr_rom, image.header.chr_ram_bytes()),
+          nametables_(image.header.mirroring()) {
+    if (prg_rom_.size() != static_cast<std::size_t>(
+                                   16u * 1024u * image.header.prg_rom_size)) {
         throw std::invalid_argument("Invalid prg_rom size");
     }
 
     if (chr_mem_.size() != static_cast<std::size_t>(8u * 1024u)) {
         throw std::invalid_argument("Invalid chr_ram size");
     }
+
+    update_prg_banks();
+    chr_banks_.map(0, 8, chr_mem_.bytes(), 0);
 }
 
 bool Mapper2::is_cpu_address_in_range(uint16_t addr) const {
-    const bool in_prg = addr >= 0x8000;
+    const bool in_prg = addr >= kPrgRomStart;
     return in_prg;
 }
 
 uint8_t Mapper2::cpu_read_byte(uint16_t addr) const {
-    if (addr >= kSwitchablePrgRomStart && addr <= kSwitchablePrgRomEnd) {
-        const uint32_t mapped_addr =
-                select_bank_low_ * 0x4000u + (addr & 0x3FFFu);
-        return prg_rom_[mapped_addr];
-    }
-
-    if (addr >= kLastBankPrgRomStart) {
-        const uint32_t mapped_addr =
-                select_bank_hi_ * 0x4000u + (addr & 0x3FFFu);
-        return prg_rom_[mapped_addr];
-    }
-
-    throw InvalidAddress(addr);
+    return prg_banks_.read(addr);
 }
 
 void Mapper2::cpu_write_byte(uint16_t addr, uint8_t byte) {
-    if (addr >= kSwitchablePrgRomStart) {
+    if (addr >= kPrgRomStart) {
+        if (Trace::enabled()) {
+            Trace::instant("Mapper2 bank switch");
+        }
         select_bank_low_ = byte & 0x0Fu;
+        update_prg_banks();
     }
 }
 
+void Mapper2::cpu_read_block(uint16_t addr, std::span<uint8_t> dst) const {
+    prg_banks_.read_block(addr, dst);
+}
+
+void Mapper2::update_prg_banks() {
+    // $8000-$BFFF is switchable, $C000-$FFFF is fixed to the last bank.
+    // Selecting a bank past the end of the rom wraps around.
+    prg_banks_.map(0, 2, prg_rom_, select_bank_low_ * kPrgBankSize);
+    prg_banks_.map(2, 2, prg_rom_, select_bank_hi_ * kPrgBankSize);
+}
+
 bool Mapper2::is_ppu_address_in_range(uint16_t addr) const {
     const bool in_chr = addr <= kChrEnd;
     const bool in_nametable = addr >= kNametableStart && addr <= kNametableEnd;
@@ -61,67 +65,19 @@ bool Mapper2::is_ppu_address_in_range(uint16_t addr) const {
 
 uint8_t Mapper2::ppu_read_byte(uint16_t addr) const {
     if (addr <= kChrEnd) {
-        return chr_mem_.at(addr);
+        return chr_banks_.read(addr);
     }
-    const auto [index, addr_mod] =
-            translate_nametable_addr(addr, header().mirroring());
-    return nametables_[index][addr_mod];
+    return nametables_.read(addr);
 }
 
 void Mapper2::ppu_write_byte(uint16_t addr, uint8_t byte) {
     if (addr <= kChrEnd) {
-        chr_mem_.at(addr) = byte;
-    }
-    const auto [index, addr_mod] =
-            translate_nametable_addr(addr, header().mirroring());
-    nametables_[index][addr_mod] = byte;
-}
-
-std::pair<int, uint16_t> Mapper2::translate_nametable_addr(uint16_t addr,
-        Mirroring m) const {
-    // TODO(johnor): This logic is identical to mapper 0 (Nrom).
-    // Refactor and move outside the mapper.
-
-    // Nametables
-    // Range        Size    Desc
-    // $2000-$23FF  $0400   Nametable 0
-    // $2400-$27FF  $0400   Nametable 1
-    // $2800-$2BFF  $0400   Nametable 2
-    // $2C00-$2FFF  $0400   Nametable 3
-    // $3000-$3EFF  $0F00   Mirrors of $2000-$2EFF
-
-    // Ignore top 4 bits to handle mirroring
-    addr &= 0x0FFFu;
-    if (m == Mirroring::Horizontal) {
-        // Nametable 0 and 1 should be the same
-        if (addr <= 0x03FF) {
-            return {0, addr % 0x0400};
-        }
-        if (addr >= 0x0400 && addr <= 0x07FF) {
-            return {0, addr % 0x0400};
-        }
-        if (addr >= 0x0800 && addr <= 0x0BFF) {
-            return {1, addr % 0x0400};
-        }
-        if (addr >= 0x0C00 && addr <= 0x0FFF) {
-            return {1, addr % 0x0400};
-        }
-    } else if (header().mirroring() == Mirroring::Vertical) {
-        // Nametable 0 and 3 should be the same
-        if (addr <= 0x03FF) {
-            return {0, addr % 0x0400};
-        }
-        if (addr >= 0x0400 && addr <= 0x07FF) {
-            return {1, addr % 0x0400};
-        }
-        if (addr >= 0x0800 && addr <= 0x0BFF) {
-            return {0, addr % 0x0400};
-        }
-        if (addr >= 0x0C00 && addr <= 0x0FFF) {
-            return {1, addr % 0x0400};
+        if (chr_mem_.write(chr_banks_.offset(addr), byte)) {
+            chr_banks_.map(0, 8, chr_mem_.bytes(), 0);
         }
+    } else {
+        nametables_.write(addr, byte);
     }
-    throw std::runtime_error("Unknown address: " + std::to_string(addr));
 }
 
 } // namespace n_e_s::core
@@ -0,0 +1,180 @@
+#include "rom/mapper_4.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include "nes/core/ines_header.h"
+#include "nes/core/trace.h"
+
+namespace n_e_s::core {
+
+Mapper4::Mapper4(const RomImage &image, PrgRam prg_ram)
+        : IRom(image.header),
+          rom_storage_(image.storage),
+          prg_rom_(image.prg_rom),
+          chr_mem_(image.chr_rom, image.header.chr_ram_bytes()),
+          prg_ram_(std::move(prg_ram)),
+          nametables_(image.header.mirroring()) {
+    if (prg_rom_.empty()) {
+        throw std::invalid_argument("Invalid prg_rom size");
+    }
+
+    update_prg_banks();
+    update_chr_banks();
+}
+
+bool Mapper4::is_cpu_address_in_range(uint16_t addr) const {
+    const bool in_prg = addr >= kPrgRamStart;
+    return in_prg;
+}
+
+uint8_t Mapper4::cpu_read_byte(uint16_t addr) const {
+    // The prg ram protect register isn't implemented since the MMC6 uses it
+    // differently and no MMC3 game depends on it.
+    if (addr <= kPrgRamEnd) {
+        return prg_ram_.read(addr - kPrgRamStart);
+    }
+
+    return prg_banks_.read(addr);
+}
+
+void Mapper4::cpu_write_byte(uint16_t addr, uint8_t byte) {
+    if (addr <= kPrgRamEnd) {
+        prg_ram_.write(addr - kPrgRamStart, byte);
+        return;
+    }
+
+    write_register(addr, byte);
+}
+
+void Mapper4::cpu_read_block(uint16_t addr, std::span<uint8_t> dst) const {
+    if (addr <= kPrgRamEnd) {
+        const auto ram_count = std::min<std::size_t>(
+                dst.size(), kPrgRomStart - addr);
+        prg_ram_.read_block(addr - kPrgRamStart, dst.first(ram_count));
+        dst = dst.subspan(ram_count);
+        addr = kPrgRomStart;
+    }
+
+    if (!dst.empty()) {
+        prg_banks_.read_block(addr, dst);
+    }
+}
+
+bool Mapper4::is_ppu_address_in_range(uint16_t addr) const {
+    const bool in_chr = addr <= kChrEnd;
+    const bool in_nametable = addr >= kNametableStart && addr <= kNametableEnd;
+    return in_chr || in_nametable;
+}
+
+uint8_t Mapper4::ppu_read_byte(uint16_t addr) const {
+    if (addr <= kChrEnd) {
+        return chr_banks_.read(addr);
+    }
+    return nametables_.read(addr);
+}
+
+void Mapper4::ppu_write_byte(uint16_t addr, uint8_t byte) {
+    if (addr <= kChrEnd) {
+        if (chr_mem_.write(chr_banks_.offset(addr), byte)) {
+            update_chr_banks();
+        }
+    } else {
+        nametables_.write(addr, byte);
+    }
+}
+
+void Mapper4::ppu_a12_rise() {
+    if (irq_counter_ == 0 || irq_reload_) {
+        irq_counter_ = irq_latch_;
+        irq_reload_ = false;
+    } else {
+        --irq_counter_;
+    }
+
+    if (irq_counter_ == 0 && irq_enabled_) {
+        set_irq(true);
+    }
+}
+
+void Mapper4::set_irq_handler(const std::function<void(bool)> &on_irq) {
+    on_irq_ = on_irq;
+}
+
+void Mapper4::write_register(uint16_t addr, uint8_t value) {
+    // Registers are selected by bits 13 and 14 and by whether the address is
+    // even or odd.
+    const bool odd = addr & 0x01u;
+    switch ((addr >> 13u) & 0x03u) {
+    case 0: // $8000-$9FFF
+        if (Trace::enabled()) {
+            Trace::instant("Mapper4 bank switch");
+        }
+        if (odd) {
+            bank_registers_[bank_select_ & 0x07u] = value;
+        } else {
+            bank_select_ = value;
+        }
+        update_prg_banks();
+        update_chr_banks();
+        break;
+    case 1: // $A000-$BFFF
+        if (!odd && nametables_.mirroring() != Mirroring::FourScreen) {
+            nametables_.set_mirroring(value & 0x01u ? Mirroring::Horizontal
+                                                    : Mirroring::Vertical);
+        }
+        break;
+    case 2: // $C000-$DFFF
+        if (odd) {
+            irq_counter_ = 0;
+            irq_reload_ = true;
+        } else {
+            irq_latch_ = value;
+        }
+        break;
+    case 3: // $E000-$FFFF
+        irq_enabled_ = odd;
+        if (!odd) {
+            set_irq(false);
+        }
+        break;
+    }
+}
+
+void Mapper4::update_prg_banks() {
+    const std::size_t second_last = prg_rom_.size() - 2 * kPrgBankSize;
+    const std::size_t r6 = bank_registers_[6] * kPrgBankSize;
+    const std::size_t r7 = bank_registers_[7] * kPrgBankSize;
+
+    // Prg mode 1 swaps $8000 and $C000.
+    const bool swapped = bank_select_ & 0x40u;
+    prg_banks_.map(0, 1, prg_rom_, swapped ? second_last : r6);
+    prg_banks_.map(1, 1, prg_rom_, r7);
+    prg_banks_.map(2, 1, prg_rom_, swapped ? r6 : second_last);
+    prg_banks_.map(3, 1, prg_rom_, prg_rom_.size() - kPrgBankSize);
+}
+
+void Mapper4::update_chr_banks() {
+    const std::span<const uint8_t> chr = chr_mem_.bytes();
+
+    // R0 and R1 switch 2 KB banks ignoring their low bits, R2-R5 switch 1 KB
+    // banks. Chr mode 1 swaps $0000-$0FFF and $1000-$1FFF.
+    const std::size_t high = bank_select_ & 0x80u ? 0 : 4;
+    const std::size_t low = 4 - high;
+    chr_banks_.map(low, 2, chr, (bank_registers_[0] & 0xFEu) * kChrBankSize);
+    chr_banks_.map(
+            low + 2, 2, chr, (bank_registers_[1] & 0xFEu) * kChrBankSize);
+    for (std::size_t i = 0; i < 4; ++i) {
+        chr_banks_.map(
+                high + i, 1, chr, bank_registers_[2 + i] * kChrBankSize);
+    }
+}
+
+void Mapper4::set_irq(bool asserted) {
+    if (asserted != irq_asserted_) {
+        irq_asserted_ = asserted;
+        on_irq_(asserted);
+    }
+}
+
+} // namespace n_e_s::core
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "nes/core/irom.h"
+#include "rom/bank_table.h"
+#include "rom/chr_memory.h"
+#include "rom/nametables.h"
+#include "rom/prg_ram.h"
+#include "rom/rom_image.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+
+namespace n_e_s::core {
+
+// MMC3, https://www.nesdev.org/wiki/MMC3
+class Mapper4 : public IRom {
+public:
+    Mapper4(const RomImage &image, PrgRam prg_ram);
+
+    [[nodiscard]] bool is_cpu_address_in_range(uint16_t addr) const override;
+    uint8_t cpu_read_byte(uint16_t addr) const override;
+    void cpu_write_byte(uint16_t addr, uint8_t byte) override;
+    void cpu_read_block(uint16_t addr,
+            std::span<uint8_t> dst) const override;
+
+    [[nodiscard]] bool is_ppu_address_in_range(uint16_t addr) const override;
+    uint8_t ppu_read_byte(uint16_t addr) const override;
+    void ppu_write_byte(uint16_t addr, uint8_t byte) override;
+
+    void ppu_a12_rise() override;
+    void set_irq_handler(const std::function<void(bool)> &on_irq) override;
+
+private:
+    void write_register(uint16_t addr, uint8_t value);
+    void update_prg_banks();
+    void update_chr_banks();
+    void set_irq(bool asserted);
+
+    // Bits 0-2 select the bank register written through $8001, bit 6 the prg
+    // mode and bit 7 the chr mode.
+    uint8_t bank_select_{0u};
+    // R0-R5 select chr banks, R6 and R7 prg banks.
+    std::array<uint8_t, 8> bank_registers_{};
+
+    uint8_t irq_latch_{0u};
+    uint8_t irq_counter_{0u};
+    bool irq_reload_{false};
+    bool irq_enabled_{false};
+    bool irq_asserted_{false};
+    std::function<void(bool)> on_irq_{[](bool) {}};
+
+    std::shared_ptr<const void> rom_storage_;
+    std::span<const uint8_t> prg_rom_;
+    ChrMemory chr_mem_;
+    PrgRam prg_ram_;
+
+    PrgBankTable prg_banks_;
+    ChrBankTable chr_banks_;
+
+    Nametables nametables_;
+
+    constexpr static uint16_t kChrEnd{0x1FFF};
+    constexpr static uint16_t kNametableStart{0x2000};
+    constexpr static uint16_t kNametableEnd{0x3EFF};
+
+    constexpr static uint16_t kPrgRamStart{0x6000};
+    constexpr static uint16_t kPrgRamEnd{0x7FFF};
+    constexpr static uint16_t kPrgRomStart{0x8000};
+
+    constexpr static std::size_t kPrgBankSize{0x2000};
+    constexpr static std::size_t kChrBankSize{0x0400};
+};
+
+} // namespace n_e_s::core
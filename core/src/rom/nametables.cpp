@@ -0,0 +1,44 @@
+#include "rom/nametables.h"
+
+#include <cstddef>
+
+namespace n_e_s::core {
+
+Nametables::Nametables(Mirroring mirroring) {
+    set_mirroring(mirroring);
+}
+
+void Nametables::set_mirroring(Mirroring mirroring) {
+    // Nametables
+    // Range        Size    Desc
+    // $2000-$23FF  $0400   Nametable 0
+    // $2400-$27FF  $0400   Nametable 1
+    // $2800-$2BFF  $0400   Nametable 2
+    // $2C00-$2FFF  $0400   Nametable 3
+    // $3000-$3EFF  $0F00   Mirrors of $2000-$2EFF
+    std::array<int, 4> layout{};
+    switch (mirroring) {
+    case Mirroring::Horizontal:
+        layout = {0, 0, 1, 1};
+        break;
+    case Mirroring::Vertical:
+        layout = {0, 1, 0, 1};
+        break;
+    case Mirroring::SingleScreenLower:
+        layout = {0, 0, 0, 0};
+        break;
+    case Mirroring::SingleScreenUpper:
+        layout = {1, 1, 1, 1};
+        break;
+    case Mirroring::FourScreen:
+        layout = {0, 1, 2, 3};
+        break;
+    }
+
+    for (std::size_t i = 0; i < pages_.size(); ++i) {
+        pages_[i] = memory_[static_cast<std::size_t>(layout[i])].data();
+    }
+    mirroring_ = mirroring;
+}
+
+} // namespace n_e_s::core
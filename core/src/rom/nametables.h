@@ -0,0 +1,42 @@
+#pragma once
+
+#include "nes/core/ines_header.h"
+
+#include <array>
+#include <cstdint>
+
+namespace n_e_s::core {
+
+// The nametables at $2000-$2FFF, mirrored up to $3EFF. The four logical
+// nametables are mapped to 1 KB pages of physical memory through a table
+// that is only updated when the mirroring changes.
+class Nametables {
+public:
+    explicit Nametables(Mirroring mirroring);
+
+    Nametables(const Nametables &) = delete;
+    Nametables &operator=(const Nametables &) = delete;
+
+    void set_mirroring(Mirroring mirroring);
+    [[nodiscard]] Mirroring mirroring() const {
+        return mirroring_;
+    }
+
+    [[nodiscard]] uint8_t read(uint16_t addr) const {
+        return pages_[(addr >> 10u) & 0x03u][addr & 0x03FFu];
+    }
+
+    void write(uint16_t addr, uint8_t byte) {
+        pages_[(addr >> 10u) & 0x03u][addr & 0x03FFu] = byte;
+    }
+
+private:
+    using Page = std::array<uint8_t, 0x0400>;
+
+    // The console has 2 KB of nametable ram, four-screen boards add 2 KB.
+    std::array<Page, 4> memory_{};
+    std::array<uint8_t *, 4> pages_{};
+    Mirroring mirroring_{};
+};
+
+} // namespace n_e_s::core
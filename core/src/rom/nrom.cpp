@@ -1,20 +1,21 @@
 #include "rom/nrom.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <stdexcept>
-#include <string>
+#include <utility>
 #include "nes/core/ines_header.h"
 
 namespace n_e_s::core {
 
-Nrom::Nrom(const INesHeader &h,
-        std::vector<uint8_t> prg_rom,
-        std::vector<uint8_t> chr_rom)
-        : IRom(h),
-          prg_rom_(std::move(prg_rom)),
-          chr_rom_(std::move(chr_rom)),
-          prg_ram_(static_cast<size_t>(h.prg_ram_size * 8 * 1024)),
-          nametables_{} {
+Nrom::Nrom(const RomImage &image, PrgRam prg_ram)
+        : IRom(image.header),
+          rom_storage_(image.storage),
+          prg_rom_(image.prg_rom),
+          chr_rom_(image.chr_rom, image.header.chr_ram_bytes()),
+          prg_ram_(std::move(prg_ram)),
+          nametables_(image.header.mirroring()) {
     if (prg_rom_.size() != 16 * 1024 && prg_rom_.size() != 32 * 1024) {
         throw std::invalid_argument("Invalid prg_rom size");
     }
@@ -22,6 +23,10 @@ Nrom::Nrom(const INesHeader &h,
     if (chr_rom_.size() != 8 * 1024) {
         throw std::invalid_argument("Invalid chr_rom size");
     }
+
+    // 16 KB prg rom is mirrored at $C000-$FFFF.
+    prg_banks_.map(0, 4, prg_rom_, 0);
+    chr_banks_.map(0, 8, chr_rom_.bytes(), 0);
 }
 
 bool Nrom::is_cpu_address_in_range(uint16_t addr) const {
@@ -31,19 +36,30 @@ bool Nrom::is_cpu_address_in_range(uint16_t addr) const {
 
 uint8_t Nrom::cpu_read_byte(uint16_t addr) const {
     if (addr <= kPrgRamEnd) {
-        addr -= kPrgRamStart;
-        return prg_ram_[addr % prg_ram_.size()];
+        return prg_ram_.read(addr - kPrgRamStart);
     }
 
-    addr -= kPrgRomStart;
-    return prg_rom_[addr % prg_rom_.size()];
+    return prg_banks_.read(addr);
 }
 
 void Nrom::cpu_write_byte(uint16_t addr, uint8_t byte) {
     // Only ram is writable
     if (addr <= kPrgRamEnd) {
-        addr -= kPrgRamStart;
-        prg_ram_[addr % prg_ram_.size()] = byte;
+        prg_ram_.write(addr - kPrgRamStart, byte);
+    }
+}
+
+void Nrom::cpu_read_block(uint16_t addr, std::span<uint8_t> dst) const {
+    if (addr <= kPrgRamEnd) {
+        const auto ram_count = std::min<std::size_t>(
+                dst.size(), kPrgRomStart - addr);
+        prg_ram_.read_block(addr - kPrgRamStart, dst.first(ram_count));
+        dst = dst.subspan(ram_count);
+        addr = kPrgRomStart;
+    }
+
+    if (!dst.empty()) {
+        prg_banks_.read_block(addr, dst);
     }
 }
 
@@ -55,64 +71,33 @@ bool Nrom::is_ppu_address_in_range(uint16_t addr) const {
 
 uint8_t Nrom::ppu_read_byte(uint16_t addr) const {
     if (addr <= kChrEnd) {
-        return chr_rom_.at(addr);
+        return chr_banks_.read(addr);
     }
-    const auto [index, addr_mod] =
-            translate_nametable_addr(addr, header().mirroring());
-    return nametables_[index][addr_mod];
+    return nametables_.read(addr);
 }
 
 void Nrom::ppu_write_byte(uint16_t addr, uint8_t byte) {
     if (addr <= kChrEnd) {
-        chr_rom_.at(addr) = byte;
+        if (chr_rom_.write(chr_banks_.offset(addr), byte)) {
+            chr_banks_.map(0, 8, chr_rom_.bytes(), 0);
+        }
+    } else {
+        nametables_.write(addr, byte);
     }
-    const auto [index, addr_mod] =
-            translate_nametable_addr(addr, header().mirroring());
-    nametables_[index][addr_mod] = byte;
 }
 
-std::pair<int, uint16_t> Nrom::translate_nametable_addr(uint16_t addr,
-        Mirroring m) const {
-    // Nametables
-    // Range        Size    Desc
-    // $2000-$23FF  $0400   Nametable 0
-    // $2400-$27FF  $0400   Nametable 1
-    // $2800-$2BFF  $0400   Nametable 2
-    // $2C00-$2FFF  $0400   Nametable 3
-    // $3000-$3EFF  $0F00   Mirrors of $2000-$2EFF
-
-    // Ignore top 4 bits to handle mirroring
-    addr &= 0x0FFFu;
-    if (m == Mirroring::Horizontal) {
-        // Nametable 0 and 1 should be the same
-        if (addr <= 0x03FF) {
-            return {0, addr % 0x0400};
-        }
-        if (addr >= 0x0400 && addr <= 0x07FF) {
-            return {0, addr % 0x0400};
-        }
-        if (addr >= 0x0800 && addr <= 0x0BFF) {
-            return {1, addr % 0x0400};
-        }
-        if (addr >= 0x0C00 && addr <= 0x0FFF) {
-            return {1, addr % 0x0400};
-        }
-    } else if (header().mirroring() == Mirroring::Vertical) {
-        // Nametable 0 and 3 should be the same
-        if (addr <= 0x03FF) {
-            return {0, addr % 0x0400};
-        }
-        if (addr >= 0x0400 && addr <= 0x07FF) {
-            return {1, addr % 0x0400};
-        }
-        if (addr >= 0x0800 && addr <= 0x0BFF) {
-            return {0, addr % 0x0400};
-        }
-        if (addr >= 0x0C00 && addr <= 0x0FFF) {
-            return {1, addr % 0x0400};
-        }
+void Nrom::ppu_read_block(uint16_t addr, std::span<uint8_t> dst) const {
+    if (addr <= kChrEnd) {
+        const auto chr_count =
+                std::min<std::size_t>(dst.size(), kNametableStart - addr);
+        chr_banks_.read_block(addr, dst.first(chr_count));
+        dst = dst.subspan(chr_count);
+        addr = kNametableStart;
+    }
+
+    for (uint8_t &byte : dst) {
+        byte = ppu_read_byte(addr++);
     }
-    throw std::runtime_error("Unknown address: " + std::to_string(addr));
 }
 
 } // namespace n_e_s::core
@@ -1,35 +1,45 @@
 #pragma once
 
 #include "nes/core/irom.h"
+#include "rom/bank_table.h"
+#include "rom/chr_memory.h"
+#include "rom/nametables.h"
+#include "rom/prg_ram.h"
+#include "rom/rom_image.h"
 
 #include <array>
-#include <vector>
+#include <cstdint>
+#include <memory>
+#include <span>
 
 namespace n_e_s::core {
 
 class Nrom : public IRom {
 public:
-    Nrom(const INesHeader &h,
-            std::vector<uint8_t> prg_rom,
-            std::vector<uint8_t> chr_rom);
+    Nrom(const RomImage &image, PrgRam prg_ram);
 
     [[nodiscard]] bool is_cpu_address_in_range(uint16_t addr) const override;
     uint8_t cpu_read_byte(uint16_t addr) const override;
     void cpu_write_byte(uint16_t addr, uint8_t byte) override;
+    void cpu_read_block(uint16_t addr,
+            std::span<uint8_t> dst) const override;
 
     [[nodiscard]] bool is_ppu_address_in_range(uint16_t addr) const override;
     uint8_t ppu_read_byte(uint16_t addr) const override;
     void ppu_write_byte(uint16_t addr, uint8_t byte) override;
+    void ppu_read_block(uint16_t addr,
+            std::span<uint8_t> dst) const override;
 
 private:
-    std::pair<int, uint16_t> translate_nametable_addr(uint16_t addr,
-            Mirroring m) const;
+    std::shared_ptr<const void> rom_storage_;
+    std::span<const uint8_t> prg_rom_;
+    ChrMemory chr_rom_;
+    PrgRam prg_ram_;
 
-    std::vector<uint8_t> prg_rom_; // const?
-    std::vector<uint8_t> chr_rom_; // const?
-    std::vector<uint8_t> prg_ram_;
+    PrgBankTable prg_banks_;
+    ChrBankTable chr_banks_;
 
-    std::array<std::array<uint8_t, 0x0400>, 2> nametables_;
+    Nametables nametables_;
 
     constexpr static uint16_t kChrEnd{0x1FFF};
     constexpr static uint16_t kNametableStart{0x2000};
@@ -0,0 +1,40 @@
+#include "rom/prg_ram.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace n_e_s::core {
+
+PrgRam::PrgRam(std::size_t size) : memory_(size), bytes_(memory_) {
+    if (bytes_.empty()) {
+        throw std::invalid_argument("Invalid prg_ram size");
+    }
+}
+
+PrgRam::PrgRam(std::size_t size, const std::filesystem::path &save_path)
+        : file_(std::make_unique<MappedFile>(save_path, size)),
+          bytes_(file_->writable_bytes()) {
+    if (bytes_.empty()) {
+        throw std::invalid_argument("Invalid prg_ram size");
+    }
+}
+
+PrgRam PrgRam::create(const INesHeader &header,
+        const std::filesystem::path &save_path) {
+    const std::size_t nvram_size = header.prg_nvram_bytes();
+    if (nvram_size != 0 && !save_path.empty()) {
+        try {
+            return PrgRam(nvram_size, save_path);
+        } catch (const std::runtime_error &) {
+            // Running without saving beats not running at all.
+        }
+    }
+
+    // The mappers map $6000-$7FFF unconditionally, so boards without prg ram
+    // get the usual 8 KB.
+    const std::size_t size =
+            std::max<std::size_t>(header.prg_ram_bytes(), nvram_size);
+    return PrgRam(size != 0 ? size : 8 * 1024);
+}
+
+} // namespace n_e_s::core
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "nes/core/ines_header.h"
+
+#include "mapped_file.h"
+#include "mirrored_memory.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace n_e_s::core {
+
+// Prg ram at $6000-$7FFF, mirrored if smaller than 8 KB. Battery backed ram
+// lives in a memory mapped save file, so saves persist without ever being
+// flushed while reads and writes stay plain memory accesses.
+class PrgRam {
+public:
+    // Ram that is lost when the rom is unloaded.
+    explicit PrgRam(std::size_t size);
+
+    // Ram kept in save_path, which is created if it doesn't exist. Throws if
+    // save_path is smaller than size.
+    PrgRam(std::size_t size, const std::filesystem::path &save_path);
+
+    // The ram described by the header, kept in save_path if it's battery
+    // backed and save_path isn't empty. If save_path can't be used, e.g.
+    // because it's read-only or in use, the ram is private instead.
+    [[nodiscard]] static PrgRam create(const INesHeader &header,
+            const std::filesystem::path &save_path);
+
+    PrgRam(PrgRam &&) = default;
+    PrgRam &operator=(PrgRam &&) = default;
+    PrgRam(const PrgRam &) = delete;
+    PrgRam &operator=(const PrgRam &) = delete;
+
+    [[nodiscard]] uint8_t read(std::size_t offset) const {
+        return bytes_[offset % bytes_.size()];
+    }
+
+    void write(std::size_t offset, uint8_t byte) {
+        bytes_[offset % bytes_.size()] = byte;
+    }
+
+    void read_block(std::size_t offset, std::span<uint8_t> dst) const {
+        read_mirrored(bytes_, offset, dst);
+    }
+
+private:
+    std::vector<uint8_t> memory_;
+    std::unique_ptr<MappedFile> file_;
+    std::span<uint8_t> bytes_;
+};
+
+} // namespace n_e_s::core
@@ -0,0 +1,60 @@
+#include "rom/rom_cache.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace n_e_s::core {
+namespace {
+
+// 64 bit FNV-1a.
+uint64_t hash(std::span<const uint8_t> bytes) {
+    uint64_t result = 0xCBF29CE484222325u;
+    for (const uint8_t byte : bytes) {
+        result = (result ^ byte) * 0x100000001B3u;
+    }
+    return result;
+}
+
+} // namespace
+
+RomCache &RomCache::instance() {
+    static RomCache cache;
+    return cache;
+}
+
+RomImage RomCache::get(std::span<const uint8_t> bytes,
+        std::shared_ptr<const void> storage) {
+    const uint64_t key = hash(bytes);
+
+    const std::lock_guard lock(mutex_);
+    std::erase_if(entries_,
+            [](const auto &entry) { return entry.second.storage.expired(); });
+
+    const auto [first, last] = entries_.equal_range(key);
+    for (auto it = first; it != last; ++it) {
+        const Entry &entry = it->second;
+        auto cached_storage = entry.storage.lock();
+        if (cached_storage && std::ranges::equal(entry.bytes, bytes)) {
+            RomImage image = entry.image;
+            image.storage = std::move(cached_storage);
+            return image;
+        }
+    }
+
+    RomImage image = RomImage::parse(bytes, storage);
+    Entry entry{image, bytes, storage};
+    entry.image.storage.reset();
+    entries_.emplace(key, std::move(entry));
+    return image;
+}
+
+std::size_t RomCache::size() const {
+    const std::lock_guard lock(mutex_);
+    return static_cast<std::size_t>(
+            std::ranges::count_if(entries_, [](const auto &entry) {
+                return !entry.second.storage.expired();
+            }));
+}
+
+} // namespace n_e_s::core
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "rom/rom_image.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+
+namespace n_e_s::core {
+
+// Process-wide cache of parsed rom images keyed by a hash of their contents,
+// so that a rom loaded by many emulator instances keeps a single copy of its
+// prg and chr rom in memory. Images are dropped together with the last rom
+// using them.
+class RomCache {
+public:
+    static RomCache &instance();
+
+    // Returns the image of an identical rom if one is alive, otherwise parses
+    // bytes, which must be owned by storage, and caches the result.
+    RomImage get(std::span<const uint8_t> bytes,
+            std::shared_ptr<const void> storage);
+
+    // The number of images currently alive.
+    [[nodiscard]] std::size_t size() const;
+
+private:
+    struct Entry {
+        RomImage image; // Without storage so the cache doesn't own it.
+        std::span<const uint8_t> bytes;
+        std::weak_ptr<const void> storage;
+    };
+
+    mutable std::mutex mutex_;
+    std::unordered_multimap<uint64_t, Entry> entries_;
+};
+
+} // namespace n_e_s::core
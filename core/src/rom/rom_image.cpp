@@ -0,0 +1,72 @@
+#include "rom/rom_image.h"
+
+#include "nes/core/rom_database.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+static_assert(sizeof(n_e_s::core::INesHeader) == 16);
+static_assert(std::is_trivially_copyable<n_e_s::core::INesHeader>::value,
+        "INesHeader must be trivially copyable for memcpy to work");
+
+namespace n_e_s::core {
+namespace {
+
+constexpr std::size_t kTrainerSize{512};
+
+} // namespace
+
+RomImage RomImage::parse(std::span<const uint8_t> bytes,
+        std::shared_ptr<const void> storage) {
+    if (bytes.size() < 16) {
+        throw std::invalid_argument(
+                "File isn't big enough to contain a header");
+    }
+
+    RomImage image;
+    INesHeader &h = image.header;
+    if (!std::equal(bytes.begin(), bytes.begin() + sizeof(h.nes), h.nes)) {
+        throw std::invalid_argument("No valid iNes header");
+    }
+
+    // This is fine because the header is exactly 16 bytes with no padding.
+    memcpy(&h, bytes.data(), sizeof(h));
+
+    const std::size_t prg_rom_start =
+            sizeof(INesHeader) + (h.has_trainer() ? kTrainerSize : 0);
+    const uint64_t prg_rom_byte_count = h.prg_rom_bytes();
+    const uint64_t chr_rom_byte_count = h.chr_rom_bytes();
+
+    // Anything after the chr rom, like PlayChoice-10 data or misc roms, is
+    // ignored.
+    const std::size_t available =
+            bytes.size() > prg_rom_start ? bytes.size() - prg_rom_start : 0;
+    if (available < prg_rom_byte_count ||
+            available - prg_rom_byte_count < chr_rom_byte_count) {
+        throw std::invalid_argument("Unexpected rom size");
+    }
+
+    // Both fit in the file, so they fit in a size_t.
+    const std::size_t prg_size = prg_rom_byte_count;
+    const std::size_t chr_size = chr_rom_byte_count;
+    image.prg_rom = bytes.subspan(prg_rom_start, prg_size);
+    image.chr_rom = bytes.subspan(prg_rom_start + prg_size, chr_size);
+    image.storage = std::move(storage);
+
+    // The prg and chr rom are contiguous, so they're hashed in one go.
+    if (has_rom_database()) {
+        const uint32_t crc =
+                crc32(bytes.subspan(prg_rom_start, prg_size + chr_size));
+        if (const RomDatabaseEntry *entry = find_in_rom_database(crc)) {
+            entry->apply_to(h);
+        }
+    }
+
+    return image;
+}
+
+} // namespace n_e_s::core
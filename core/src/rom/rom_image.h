@@ -0,0 +1,26 @@
+#pragma once
+
+#include "nes/core/ines_header.h"
+
+#include <cstdint>
+#include <memory>
+#include <span>
+
+namespace n_e_s::core {
+
+// A parsed rom file. The prg and chr rom point into storage, which owns the
+// file contents and may be memory mapped and shared by several roms. Headers
+// of roms found in the rom database are replaced with what it knows.
+struct RomImage {
+    INesHeader header{};
+    std::span<const uint8_t> prg_rom;
+    std::span<const uint8_t> chr_rom; // Empty if the board uses chr ram.
+    std::shared_ptr<const void> storage;
+
+    // Throws std::invalid_argument if bytes isn't a valid iNes or NES 2.0
+    // file.
+    static RomImage parse(std::span<const uint8_t> bytes,
+            std::shared_ptr<const void> storage);
+};
+
+} // namespace n_e_s::core
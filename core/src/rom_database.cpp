@@ -0,0 +1,30 @@
+#include "nes/core/rom_database.h"
+
+namespace n_e_s::core {
+namespace {
+
+// The entries are generated from an external database into
+// rom/rom_database.inc as a list of RomDatabaseEntry initializers, e.g.
+// {0x12345678, 4, 0, Mirroring::Vertical, 0, 8192, 0, Timing::Ntsc},
+// Without that file the database is empty and headers are used as is.
+#if __has_include("rom/rom_database.inc")
+constexpr std::array kEntries = std::to_array<RomDatabaseEntry>({
+#include "rom/rom_database.inc"
+});
+#else
+constexpr std::array<RomDatabaseEntry, 0> kEntries{};
+#endif
+
+constexpr RomDatabase kDatabase{kEntries};
+
+} // namespace
+
+const RomDatabaseEntry *find_in_rom_database(uint32_t crc) {
+    return kDatabase.find(crc);
+}
+
+bool has_rom_database() {
+    return !kEntries.empty();
+}
+
+} // namespace n_e_s::core
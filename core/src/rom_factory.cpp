@@ -1,23 +1,26 @@
 #include "nes/core/rom_factory.h"
 
+#include "mapped_file.h"
+#include "rom/mapper_1.h"
 #include "rom/mapper_2.h"
 #include "rom/mapper_3.h"
+#include "rom/mapper_4.h"
 #include "rom/nrom.h"
+#include "rom/prg_ram.h"
+#include "rom/rom_cache.h"
+#include "rom/rom_image.h"
 
 #include <fmt/format.h>
 #include <cassert>
 #include <cstddef>
-#include <cstring>
 #include <istream>
 #include <limits>
+#include <memory>
+#include <span>
 #include <stdexcept>
-#include <type_traits>
+#include <utility>
 #include <vector>
 
-static_assert(sizeof(n_e_s::core::INesHeader) == 16);
-static_assert(std::is_trivially_copyable<n_e_s::core::INesHeader>::value,
-        "INesHeader must be trivially copyable for memcpy to work");
-
 namespace {
 
 size_t streamsize(std::istream &stream) {
@@ -33,71 +36,64 @@ size_t streamsize(std::istream &stream) {
 } // namespace
 
 namespace n_e_s::core {
+namespace {
 
-std::unique_ptr<IRom> RomFactory::from_bytes(std::istream &bytestream) {
-    std::vector<uint8_t> bytes(streamsize(bytestream));
-    if (bytes.size() < 16) {
-        throw std::invalid_argument(
-                "File isn't big enough to contain a header");
-    }
+// Battery backed prg ram is kept in save_path if it isn't empty.
+std::unique_ptr<IRom> create_rom(const RomImage &image,
+        const std::filesystem::path &save_path = {}) {
+    const auto prg_ram = [&] {
+        return PrgRam::create(image.header, save_path);
+    };
 
-    const auto size = static_cast<std::streamsize>(bytes.size());
-    if (!bytestream.read(reinterpret_cast<char *>(&bytes[0]), size)) {
-        throw std::invalid_argument("Unable to get bytes");
+    const uint16_t mapper = image.header.mapper();
+    if (mapper == 0) {
+        return std::make_unique<Nrom>(image, prg_ram());
     }
-
-    INesHeader h;
-    if (!std::equal(bytes.begin(), bytes.begin() + sizeof(h.nes), h.nes)) {
-        throw std::invalid_argument("No valid iNes header");
+    if (mapper == 1) {
+        return std::make_unique<Mapper1>(image, prg_ram());
     }
-
-    // This is fine because the header is exactly 16 bytes with no padding.
-    memcpy(&h, &bytes[0], sizeof(h));
-    if (h.prg_ram_size == 0) {
-        h.prg_ram_size = 1; // For compatibility reasons, 0 ram means 1 ram.
+    if (mapper == 2) {
+        return std::make_unique<Mapper2>(image);
+    }
+    if (mapper == 3) {
+        return std::make_unique<Mapper3>(image);
+    }
+    if (mapper == 4) {
+        return std::make_unique<Mapper4>(image, prg_ram());
     }
 
-    uint8_t mapper = static_cast<uint8_t>(h.flags_6 & 0xF0u) >> 4u;
-    mapper |= h.flags_7 & 0xF0u;
+    throw std::logic_error(fmt::format("Unsupported mapper: {}", mapper));
+}
 
-    const auto prg_rom_byte_count =
-            static_cast<uint32_t>(h.prg_rom_size * 16 * 1024);
-    const auto chr_rom_byte_count =
-            static_cast<uint32_t>(h.chr_rom_size * 8 * 1024);
+} // namespace
 
-    const uint32_t expected_rom_size =
-            sizeof(INesHeader) + prg_rom_byte_count + chr_rom_byte_count;
-    if (bytes.size() != expected_rom_size) {
-        throw std::invalid_argument("Unexpected rom size");
+std::unique_ptr<IRom> RomFactory::from_bytes(std::istream &bytestream) {
+    auto bytes = std::make_shared<std::vector<uint8_t>>(streamsize(bytestream));
+    if (bytes->size() < 16) {
+        throw std::invalid_argument(
+                "File isn't big enough to contain a header");
     }
 
-    std::vector<uint8_t> prg_rom(bytes.begin() + sizeof(INesHeader),
-            bytes.begin() + sizeof(INesHeader) + prg_rom_byte_count);
-
-    std::vector<uint8_t> chr_memory;
-    if (h.chr_rom_size == 0) {
-        // No chr rom, game uses chr ram
-        // Allocate ram with enough size:
-        // https://www.nesdev.org/wiki/CHR_ROM_vs._CHR_RAM
-        chr_memory.resize(static_cast<std::size_t>(8u * 1024u));
-    } else {
-        chr_memory = std::vector<uint8_t>(
-                bytes.begin() + sizeof(INesHeader) + prg_rom_byte_count,
-                bytes.begin() + sizeof(INesHeader) + prg_rom_byte_count +
-                        chr_rom_byte_count);
+    const auto size = static_cast<std::streamsize>(bytes->size());
+    if (!bytestream.read(reinterpret_cast<char *>(bytes->data()), size)) {
+        throw std::invalid_argument("Unable to get bytes");
     }
 
-    if (mapper == 0) {
-        return std::make_unique<Nrom>(h, prg_rom, chr_memory);
-    }
-    if (mapper == 2) {
-        return std::make_unique<Mapper2>(h, prg_rom, chr_memory);
-    }
-    if (mapper == 3) {
-        return std::make_unique<Mapper3>(h, prg_rom, chr_memory);
-    }
+    const std::span<const uint8_t> view = *bytes;
+    return create_rom(RomCache::instance().get(view, std::move(bytes)));
+}
 
-    throw std::logic_error(fmt::format("Unsupported mapper: {}", mapper));
+std::unique_ptr<IRom> RomFactory::from_file(const std::filesystem::path &path,
+        const std::filesystem::path &save_path) {
+    // The mappers read prg and chr rom straight out of the mapped file.
+    auto file = std::make_shared<const MappedFile>(path);
+    const auto bytes = file->bytes();
+    return create_rom(RomCache::instance().get(bytes, std::move(file)),
+            save_path);
+}
+
+std::size_t RomFactory::cached_image_count() {
+    return RomCache::instance().size();
 }
 
 } // namespace n_e_s::core
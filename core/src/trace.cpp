@@ -0,0 +1,176 @@
+#include "nes/core/trace.h"
+
+#include <fmt/format.h>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+struct Event {
+    const char *name;
+    int64_t timestamp_ns;
+    char phase;
+};
+
+constexpr std::size_t kChunkSize{4096};
+
+struct Chunk {
+    std::array<Event, kChunkSize> events{};
+    // Written by the owning thread, read by whoever writes the trace.
+    std::atomic<std::size_t> size{0};
+    std::atomic<Chunk *> next{nullptr};
+};
+
+// Events are stored in a linked list of fixed size chunks so that recording
+// never has to move already recorded events and never blocks on a reader.
+class ThreadBuffer {
+public:
+    explicit ThreadBuffer(uint32_t tid)
+            : tid_(tid), head_(new Chunk), tail_(head_) {}
+
+    ~ThreadBuffer() {
+        delete_chunks_after(head_);
+        delete head_;
+    }
+
+    ThreadBuffer(const ThreadBuffer &) = delete;
+    ThreadBuffer &operator=(const ThreadBuffer &) = delete;
+
+    void push(const char *name, char phase) {
+        std::size_t size = tail_->size.load(std::memory_order_relaxed);
+        if (size == kChunkSize) {
+            auto *chunk = new Chunk;
+            tail_->next.store(chunk, std::memory_order_release);
+            tail_ = chunk;
+            size = 0;
+        }
+
+        const auto now = std::chrono::steady_clock::now().time_since_epoch();
+        tail_->events[size] = Event{name,
+                std::chrono::duration_cast<std::chrono::nanoseconds>(now)
+                        .count(),
+                phase};
+        tail_->size.store(size + 1, std::memory_order_release);
+    }
+
+    template <typename Fn>
+    void for_each(Fn fn) const {
+        for (const Chunk *chunk = head_; chunk != nullptr;
+                chunk = chunk->next.load(std::memory_order_acquire)) {
+            const std::size_t size =
+                    chunk->size.load(std::memory_order_acquire);
+            for (std::size_t i = 0; i < size; ++i) {
+                fn(chunk->events[i]);
+            }
+        }
+    }
+
+    void clear() {
+        delete_chunks_after(head_);
+        head_->size.store(0, std::memory_order_release);
+        tail_ = head_;
+    }
+
+    uint32_t tid() const {
+        return tid_;
+    }
+
+private:
+    static void delete_chunks_after(Chunk *chunk) {
+        Chunk *next = chunk->next.exchange(nullptr);
+        while (next != nullptr) {
+            Chunk *const to_delete = next;
+            next = next->next.load();
+            delete to_delete;
+        }
+    }
+
+    const uint32_t tid_;
+    Chunk *const head_;
+    Chunk *tail_;
+};
+
+// Buffers are kept alive after their threads exit so that their events can
+// still be written out.
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+};
+
+Registry &registry() {
+    static Registry registry;
+    return registry;
+}
+
+ThreadBuffer &thread_buffer() {
+    thread_local ThreadBuffer *const buffer = [] {
+        Registry &r = registry();
+        const std::lock_guard lock(r.mutex);
+        const auto tid = static_cast<uint32_t>(r.buffers.size());
+        return r.buffers.emplace_back(std::make_unique<ThreadBuffer>(tid))
+                .get();
+    }();
+    return *buffer;
+}
+
+} // namespace
+
+namespace n_e_s::core {
+
+void Trace::enable(bool enabled) {
+    enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+void Trace::begin(const char *name) {
+    thread_buffer().push(name, 'B');
+}
+
+void Trace::end(const char *name) {
+    thread_buffer().push(name, 'E');
+}
+
+void Trace::instant(const char *name) {
+    thread_buffer().push(name, 'i');
+}
+
+void Trace::write_json(std::ostream &os) {
+    Registry &r = registry();
+    const std::lock_guard lock(r.mutex);
+
+    os << "{\"traceEvents\":[";
+    bool first = true;
+    for (const auto &buffer : r.buffers) {
+        buffer->for_each([&](const Event &e) {
+            os << (first ? "\n" : ",\n");
+            first = false;
+            os << fmt::format(
+                    R"({{"name":"{}","ph":"{}","ts":{}.{:03},"pid":1,"tid":{})",
+                    e.name,
+                    e.phase,
+                    e.timestamp_ns / 1000,
+                    e.timestamp_ns % 1000,
+                    buffer->tid());
+            if (e.phase == 'i') {
+                os << R"(,"s":"t")";
+            }
+            os << '}';
+        });
+    }
+    os << "\n]}\n";
+}
+
+void Trace::clear() {
+    Registry &r = registry();
+    const std::lock_guard lock(r.mutex);
+    for (const auto &buffer : r.buffers) {
+        buffer->clear();
+    }
+}
+
+} // namespace n_e_s::core
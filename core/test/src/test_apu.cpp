@@ -1,53 +1,497 @@
 #include "nes/core/apu_factory.h"
+#include "nes/core/imos6502.h"
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
 using namespace n_e_s::core;
 
 namespace {
 
+constexpr uint32_t kCpuCyclesPerSecond{1789773};
+// The frame irq is raised this many cycles into the 4-step sequence.
+constexpr uint32_t kFrameIrqCycle{29829};
+constexpr uint32_t kFrameSequenceCycles{29830};
+
 class ApuTest : public ::testing::Test {
 public:
     ApuTest() : apu(ApuFactory::create()) {}
 
-    void step_execution(uint32_t cycles) {
-        for (uint32_t i = 0; i < cycles; ++i) {
-            apu->execute();
-        }
+    void run_cycles(uint32_t cycles) {
+        cycle += cycles;
+        apu->run_until(cycle);
+    }
+
+    // Loads the length counters of all channels but the dmc with
+    // length_index.
+    void load_length_counters(uint8_t length_index) {
+        const auto byte = static_cast<uint8_t>(length_index << 3u);
+        apu->write_byte(0x4003, byte);
+        apu->write_byte(0x4007, byte);
+        apu->write_byte(0x400B, byte);
+        apu->write_byte(0x400F, byte);
+    }
+
+    // A 440 Hz square wave at full volume.
+    void play_pulse_1() {
+        apu->write_byte(0x4015, 0x01);
+        apu->write_byte(0x4000, 0xBF);
+        apu->write_byte(0x4002, 0xFD);
+        apu->write_byte(0x4003, 0x00);
+    }
+
+    static IApu::SampleSink append_to(std::vector<int16_t> &samples) {
+        return [&samples](std::span<const int16_t> block) {
+            samples.insert(samples.end(), block.begin(), block.end());
+        };
     }
 
     std::unique_ptr<IApu> apu;
+    uint64_t cycle{0};
 };
 
-// Placeholder for future tests
-// For now only dummy test...
-TEST_F(ApuTest, dummy_test) {
-    EXPECT_EQ(0x00, apu->read_byte(0x1234));
-    apu->write_byte(0x0000, 0x00);
-    int8_t sample{};
-    int8_t sample_pulse_1{};
-    int8_t sample_pulse_2{};
-    int8_t sample_triangle{};
-    int8_t sample_noise{};
-    int8_t sample_pcm{};
-    apu->execute();
-    apu->set_sample_handler([&sample](int8_t s) { sample = s; });
-    apu->set_sample_handler_pulse_1(
-            [&sample_pulse_1](int8_t s) { sample_pulse_1 = s; });
-    apu->set_sample_handler_pulse_2(
-            [&sample_pulse_2](int8_t s) { sample_pulse_2 = s; });
-    apu->set_sample_handler_triangle(
-            [&sample_triangle](int8_t s) { sample_triangle = s; });
-    apu->set_sample_handler_noise(
-            [&sample_noise](int8_t s) { sample_noise = s; });
-    apu->set_sample_handler_pcm([&sample_pcm](int8_t s) { sample_pcm = s; });
-    apu->execute();
-    EXPECT_EQ(sample, 0x01);
-    EXPECT_EQ(sample_pulse_1, 0x02);
-    EXPECT_EQ(sample_pulse_2, 0x03);
-    EXPECT_EQ(sample_triangle, 0x04);
-    EXPECT_EQ(sample_noise, 0x05);
-    EXPECT_EQ(sample_pcm, 0x06);
-}
-
-} // namespace
\ No newline at end of file
+TEST_F(ApuTest, unmapped_registers_read_zero) {
+    EXPECT_EQ(0x00, apu->read_byte(0x4000));
+    EXPECT_EQ(0x00, apu->read_byte(0x4017));
+}
+
+TEST_F(ApuTest, status_reports_loaded_length_counters) {
+    EXPECT_EQ(0x00, apu->read_byte(0x4015));
+
+    apu->write_byte(0x4015, 0x0F);
+    load_length_counters(1);
+
+    EXPECT_EQ(0x0F, apu->read_byte(0x4015));
+}
+
+TEST_F(ApuTest, length_counters_not_loaded_while_disabled) {
+    apu->write_byte(0x4015, 0x05);
+    load_length_counters(1);
+
+    EXPECT_EQ(0x05, apu->read_byte(0x4015));
+}
+
+TEST_F(ApuTest, disabling_a_channel_clears_its_length_counter) {
+    apu->write_byte(0x4015, 0x0F);
+    load_length_counters(1);
+
+    apu->write_byte(0x4015, 0x0A);
+
+    EXPECT_EQ(0x0A, apu->read_byte(0x4015));
+}
+
+TEST_F(ApuTest, length_counters_count_down_on_half_frames) {
+    apu->write_byte(0x4015, 0x0F);
+    load_length_counters(3); // A length of 2.
+
+    // One half frame in.
+    run_cycles(16000);
+    EXPECT_EQ(0x0F, apu->read_byte(0x4015) & 0x0Fu);
+
+    // Two half frames in.
+    run_cycles(14000);
+    EXPECT_EQ(0x00, apu->read_byte(0x4015) & 0x0Fu);
+}
+
+TEST_F(ApuTest, halted_length_counters_dont_count_down) {
+    apu->write_byte(0x4015, 0x01);
+    apu->write_byte(0x4000, 0x20);
+    apu->write_byte(0x4003, 3u << 3u);
+
+    run_cycles(kFrameSequenceCycles * 2);
+
+    EXPECT_EQ(0x01, apu->read_byte(0x4015) & 0x0Fu);
+}
+
+TEST_F(ApuTest, frame_irq_at_the_end_of_the_4_step_sequence) {
+    std::vector<std::pair<uint8_t, bool>> irqs;
+    apu->set_irq_handler([&](uint8_t sources, bool asserted) {
+        irqs.emplace_back(sources, asserted);
+    });
+
+    run_cycles(kFrameIrqCycle - 1);
+    EXPECT_TRUE(irqs.empty());
+
+    run_cycles(1);
+    ASSERT_EQ(1u, irqs.size());
+    EXPECT_EQ(IRQ_APU_FRAME_COUNTER, irqs[0].first);
+    EXPECT_TRUE(irqs[0].second);
+}
+
+TEST_F(ApuTest, frame_irq_is_scheduled_ahead_of_time) {
+    std::vector<std::pair<uint8_t, uint64_t>> scheduled;
+    apu->set_irq_scheduler([&](uint8_t sources, uint64_t at) {
+        scheduled.emplace_back(sources, at);
+    });
+
+    ASSERT_EQ(1u, scheduled.size());
+    EXPECT_EQ(IRQ_APU_FRAME_COUNTER, scheduled[0].first);
+    EXPECT_EQ(kFrameIrqCycle, scheduled[0].second);
+
+    // Acknowledging the irq schedules the next one.
+    run_cycles(kFrameSequenceCycles);
+    apu->read_byte(0x4015);
+
+    ASSERT_EQ(2u, scheduled.size());
+    EXPECT_EQ(kFrameSequenceCycles + kFrameIrqCycle, scheduled[1].second);
+}
+
+TEST_F(ApuTest, pal_frame_sequence_is_longer) {
+    apu = ApuFactory::create(Timing::Pal);
+    std::vector<std::pair<uint8_t, uint64_t>> scheduled;
+    apu->set_irq_scheduler([&](uint8_t sources, uint64_t at) {
+        scheduled.emplace_back(sources, at);
+    });
+
+    ASSERT_EQ(1u, scheduled.size());
+    EXPECT_EQ(33253u, scheduled[0].second);
+
+    run_cycles(kFrameSequenceCycles);
+    EXPECT_EQ(0x00, apu->read_byte(0x4015));
+    run_cycles(33254 - kFrameSequenceCycles);
+    EXPECT_EQ(0x40, apu->read_byte(0x4015));
+}
+
+TEST_F(ApuTest, inhibiting_the_frame_irq_cancels_the_scheduled_one) {
+    std::vector<bool> irqs;
+    apu->set_irq_handler(
+            [&](uint8_t, bool asserted) { irqs.push_back(asserted); });
+
+    apu->write_byte(0x4017, 0x40);
+
+    EXPECT_EQ((std::vector<bool>{false}), irqs);
+}
+
+TEST_F(ApuTest, reading_status_clears_the_frame_irq) {
+    std::vector<bool> irqs;
+    apu->set_irq_handler(
+            [&](uint8_t, bool asserted) { irqs.push_back(asserted); });
+    run_cycles(kFrameSequenceCycles);
+
+    EXPECT_EQ(0x40, apu->read_byte(0x4015));
+    EXPECT_EQ(0x00, apu->read_byte(0x4015));
+    EXPECT_EQ((std::vector<bool>{true, false}), irqs);
+}
+
+TEST_F(ApuTest, setting_irq_inhibit_clears_the_frame_irq) {
+    run_cycles(kFrameSequenceCycles);
+
+    apu->write_byte(0x4017, 0x40);
+
+    EXPECT_EQ(0x00, apu->read_byte(0x4015));
+}
+
+TEST_F(ApuTest, no_frame_irq_when_inhibited) {
+    apu->write_byte(0x4017, 0x40);
+
+    run_cycles(kFrameSequenceCycles * 2);
+
+    EXPECT_EQ(0x00, apu->read_byte(0x4015));
+}
+
+TEST_F(ApuTest, no_frame_irq_in_5_step_mode) {
+    apu->write_byte(0x4017, 0x80);
+
+    run_cycles(kFrameSequenceCycles * 2);
+
+    EXPECT_EQ(0x00, apu->read_byte(0x4015));
+}
+
+TEST_F(ApuTest, 5_step_mode_clocks_a_half_frame_when_set) {
+    apu->write_byte(0x4015, 0x01);
+    apu->write_byte(0x4003, 0x18); // A length of 2.
+
+    apu->write_byte(0x4017, 0x80);
+    apu->write_byte(0x4017, 0x80);
+
+    EXPECT_EQ(0x00, apu->read_byte(0x4015));
+}
+
+TEST_F(ApuTest, register_accesses_catch_up_to_the_cpu_clock) {
+    apu->set_cpu_clock([this] { return cycle; });
+    apu->write_byte(0x4015, 0x01);
+    apu->write_byte(0x4003, 0x18); // A length of 2.
+
+    cycle = kFrameSequenceCycles;
+
+    EXPECT_EQ(0x40, apu->read_byte(0x4015));
+}
+
+TEST_F(ApuTest, enabling_the_dmc_schedules_a_dma_right_away) {
+    std::vector<std::optional<uint64_t>> scheduled;
+    apu->set_dma_scheduler([&](std::optional<uint64_t> at) {
+        scheduled.push_back(at);
+    });
+    run_cycles(10);
+
+    apu->write_byte(0x4012, 0x01);
+    apu->write_byte(0x4015, 0x10);
+
+    ASSERT_FALSE(scheduled.empty());
+    EXPECT_EQ(10u, scheduled.back());
+    EXPECT_EQ(0x10, apu->read_byte(0x4015));
+
+    apu->write_byte(0x4015, 0x00);
+    EXPECT_EQ(std::nullopt, scheduled.back());
+    EXPECT_EQ(0x00, apu->read_byte(0x4015));
+}
+
+TEST_F(ApuTest, dmc_reads_samples_at_its_rate) {
+    std::vector<uint16_t> reads;
+    apu->set_dma_reader([&](uint16_t addr) -> uint8_t {
+        reads.push_back(addr);
+        return 0xFF;
+    });
+    std::optional<uint64_t> scheduled;
+    apu->set_dma_scheduler([&](std::optional<uint64_t> at) { scheduled = at; });
+
+    apu->write_byte(0x4010, 0x0F); // 54 cycles per bit.
+    apu->write_byte(0x4012, 0x01); // $C040
+    apu->write_byte(0x4013, 0x01); // 17 bytes
+    apu->write_byte(0x4015, 0x10);
+
+    std::vector<uint64_t> dmas;
+    while (scheduled) {
+        dmas.push_back(*scheduled);
+        apu->dma(*scheduled);
+    }
+
+    ASSERT_EQ(17u, reads.size());
+    EXPECT_EQ(0xC040, reads.front());
+    EXPECT_EQ(0xC050, reads.back());
+    // The first byte goes straight into the buffer, and then the buffer is
+    // emptied every 8 bits.
+    for (std::size_t i = 2; i < dmas.size(); ++i) {
+        EXPECT_EQ(8u * 54u, dmas[i] - dmas[i - 1]);
+    }
+    EXPECT_EQ(0x00, apu->read_byte(0x4015));
+}
+
+TEST_F(ApuTest, dmc_irq_when_a_sample_ends) {
+    std::vector<std::pair<uint8_t, bool>> irqs;
+    apu->set_irq_handler([&](uint8_t sources, bool asserted) {
+        irqs.emplace_back(sources, asserted);
+    });
+    apu->write_byte(0x4017, 0x40); // No frame irqs.
+    irqs.clear();
+
+    apu->write_byte(0x4010, 0x80);
+    apu->write_byte(0x4015, 0x10);
+    apu->dma(0);
+
+    ASSERT_EQ(1u, irqs.size());
+    EXPECT_EQ(IRQ_APU_DMC, irqs[0].first);
+    EXPECT_TRUE(irqs[0].second);
+    EXPECT_EQ(0x80, apu->read_byte(0x4015));
+    // Reading doesn't clear it, but writing to the status does.
+    EXPECT_EQ(0x80, apu->read_byte(0x4015));
+
+    apu->write_byte(0x4015, 0x00);
+    EXPECT_EQ(0x00, apu->read_byte(0x4015));
+    ASSERT_EQ(2u, irqs.size());
+    EXPECT_FALSE(irqs[1].second);
+}
+
+TEST_F(ApuTest, looping_dmc_sample_restarts) {
+    std::vector<uint16_t> reads;
+    apu->set_dma_reader([&](uint16_t addr) -> uint8_t {
+        reads.push_back(addr);
+        return 0x00;
+    });
+    std::optional<uint64_t> scheduled;
+    apu->set_dma_scheduler([&](std::optional<uint64_t> at) { scheduled = at; });
+
+    apu->write_byte(0x4010, 0xCF); // Loop and irq enabled.
+    apu->write_byte(0x4015, 0x10);
+    for (int i = 0; i < 3 && scheduled; ++i) {
+        apu->dma(*scheduled);
+    }
+
+    EXPECT_EQ((std::vector<uint16_t>{0xC000, 0xC000, 0xC000}), reads);
+    EXPECT_EQ(0x10, apu->read_byte(0x4015));
+}
+
+TEST_F(ApuTest, dmc_output_follows_the_sample_bits) {
+    std::vector<int16_t> samples;
+    apu->set_channel_sample_sink(IApu::Channel::Dmc, append_to(samples));
+    apu->set_dma_reader([](uint16_t) -> uint8_t { return 0xFF; });
+    std::optional<uint64_t> scheduled;
+    apu->set_dma_scheduler([&](std::optional<uint64_t> at) { scheduled = at; });
+
+    apu->write_byte(0x4010, 0x4F); // Loop as fast as possible.
+    apu->write_byte(0x4011, 0x00);
+    apu->write_byte(0x4015, 0x10);
+    while (scheduled && *scheduled < kCpuCyclesPerSecond / 10) {
+        apu->dma(*scheduled);
+    }
+    run_cycles(kCpuCyclesPerSecond / 10);
+
+    // All ones ramp the level up from 0.
+    EXPECT_EQ(0x10, apu->read_byte(0x4015) & 0x1Fu);
+    ASSERT_FALSE(samples.empty());
+    EXPECT_GT(*std::max_element(samples.begin(), samples.end()),
+            samples.front() + 10000);
+}
+
+TEST_F(ApuTest, running_in_one_go_matches_running_cycle_by_cycle) {
+    std::vector<int16_t> one_go;
+    apu->set_sample_sink(append_to(one_go));
+    play_pulse_1();
+    run_cycles(kCpuCyclesPerSecond / 10);
+
+    std::vector<int16_t> cycle_by_cycle;
+    apu = ApuFactory::create();
+    cycle = 0;
+    apu->set_sample_sink(append_to(cycle_by_cycle));
+    play_pulse_1();
+    for (uint32_t i = 0; i < kCpuCyclesPerSecond / 10; ++i) {
+        run_cycles(1);
+    }
+
+    EXPECT_EQ(one_go, cycle_by_cycle);
+}
+
+TEST_F(ApuTest, delivers_samples_at_the_sample_rate) {
+    std::size_t samples = 0;
+    apu->set_sample_sink(
+            [&](std::span<const int16_t> block) { samples += block.size(); });
+
+    run_cycles(kCpuCyclesPerSecond);
+
+    // Samples are delivered a few ms at a time.
+    EXPECT_NEAR(44100, samples, 200);
+
+    samples = 0;
+    apu->set_sample_rate(48000);
+    run_cycles(kCpuCyclesPerSecond);
+
+    EXPECT_NEAR(48000, samples, 200);
+}
+
+TEST_F(ApuTest, delivers_samples_in_blocks) {
+    std::vector<std::size_t> blocks;
+    apu->set_sample_sink([&](std::span<const int16_t> block) {
+        blocks.push_back(block.size());
+    });
+
+    run_cycles(kCpuCyclesPerSecond / 10);
+
+    ASSERT_GT(blocks.size(), 1u);
+    EXPECT_GT(blocks.front(), 50u);
+}
+
+TEST_F(ApuTest, silent_when_nothing_plays) {
+    std::vector<int16_t> samples;
+    apu->set_sample_sink(append_to(samples));
+
+    run_cycles(kCpuCyclesPerSecond / 10);
+
+    ASSERT_FALSE(samples.empty());
+    EXPECT_TRUE(std::all_of(
+            samples.begin(), samples.end(), [](int16_t s) { return s == 0; }));
+}
+
+TEST_F(ApuTest, pulse_plays_a_square_wave) {
+    std::vector<int16_t> samples;
+    apu->set_sample_sink(append_to(samples));
+    play_pulse_1();
+
+    run_cycles(kCpuCyclesPerSecond / 10);
+
+    const auto [min, max] = std::minmax_element(samples.begin(), samples.end());
+    EXPECT_LT(*min, -1000);
+    EXPECT_GT(*max, 1000);
+}
+
+TEST_F(ApuTest, mixer_is_non_linear) {
+    const auto peak_to_peak = [this](bool both_pulses) {
+        apu = ApuFactory::create();
+        cycle = 0;
+        std::vector<int16_t> samples;
+        apu->set_sample_sink(append_to(samples));
+        play_pulse_1();
+        if (both_pulses) {
+            // The same wave, in phase with pulse 1.
+            apu->write_byte(0x4015, 0x03);
+            apu->write_byte(0x4004, 0xBF);
+            apu->write_byte(0x4006, 0xFD);
+            apu->write_byte(0x4007, 0x00);
+        }
+
+        run_cycles(kCpuCyclesPerSecond / 10);
+        const auto [min, max] =
+                std::minmax_element(samples.begin(), samples.end());
+        return static_cast<double>(*max - *min);
+    };
+
+    // Twice the level is about 1.74 times as loud, not twice as loud.
+    EXPECT_NEAR(1.74, peak_to_peak(true) / peak_to_peak(false), 0.05);
+}
+
+TEST_F(ApuTest, every_resampling_quality_plays_the_same_wave) {
+    std::vector<std::vector<int16_t>> waves;
+    for (const auto quality : {IApu::ResamplingQuality::Low,
+                 IApu::ResamplingQuality::Medium,
+                 IApu::ResamplingQuality::High}) {
+        apu = ApuFactory::create();
+        cycle = 0;
+        apu->set_resampling_quality(quality);
+        apu->set_sample_sink(append_to(waves.emplace_back()));
+        play_pulse_1();
+
+        run_cycles(kCpuCyclesPerSecond / 10);
+    }
+
+    // The kernels delay the output differently, so compare the energy.
+    const auto energy = [](const std::vector<int16_t> &wave) {
+        double sum = 0.0;
+        for (const int16_t sample : wave) {
+            sum += static_cast<double>(sample) * sample;
+        }
+        return sum / static_cast<double>(wave.size());
+    };
+    ASSERT_EQ(waves[0].size(), waves[1].size());
+    ASSERT_EQ(waves[0].size(), waves[2].size());
+    EXPECT_NEAR(1.0, energy(waves[0]) / energy(waves[1]), 0.05);
+    EXPECT_NEAR(1.0, energy(waves[2]) / energy(waves[1]), 0.05);
+}
+
+TEST_F(ApuTest, channels_can_be_listened_to_on_their_own) {
+    std::vector<int16_t> pulse_1;
+    std::vector<int16_t> triangle;
+    apu->set_channel_sample_sink(IApu::Channel::Pulse1, append_to(pulse_1));
+    apu->set_channel_sample_sink(IApu::Channel::Triangle, append_to(triangle));
+    play_pulse_1();
+
+    run_cycles(kCpuCyclesPerSecond / 10);
+
+    ASSERT_EQ(pulse_1.size(), triangle.size());
+    EXPECT_TRUE(std::any_of(pulse_1.begin(), pulse_1.end(), [](int16_t s) {
+        return s > 1000;
+    }));
+    EXPECT_TRUE(std::all_of(triangle.begin(), triangle.end(), [](int16_t s) {
+        return s == 0;
+    }));
+}
+
+TEST_F(ApuTest, sinks_can_be_removed) {
+    std::vector<int16_t> mixed;
+    std::vector<int16_t> noise;
+    apu->set_sample_sink(append_to(mixed));
+    apu->set_channel_sample_sink(IApu::Channel::Noise, append_to(noise));
+    apu->set_sample_sink({});
+    apu->set_channel_sample_sink(IApu::Channel::Noise, {});
+
+    run_cycles(kCpuCyclesPerSecond / 10);
+
+    EXPECT_TRUE(mixed.empty());
+    EXPECT_TRUE(noise.empty());
+}
+
+} // namespace
@@ -0,0 +1,118 @@
+#include "nes/core/audio_ring_buffer.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace n_e_s::core;
+
+namespace {
+
+TEST(AudioRingBuffer, capacity_is_rounded_up_to_a_power_of_two) {
+    EXPECT_EQ(1024u, AudioRingBuffer(1000).capacity());
+    EXPECT_EQ(1024u, AudioRingBuffer(1024).capacity());
+}
+
+TEST(AudioRingBuffer, pops_what_was_pushed_in_order) {
+    AudioRingBuffer buffer(8);
+    std::array<int16_t, 3> dst{};
+
+    // Go around a few times to cover wrapping.
+    for (int16_t i = 0; i < 10; ++i) {
+        const std::array<int16_t, 3> src{
+                i, static_cast<int16_t>(i + 1), static_cast<int16_t>(i + 2)};
+        EXPECT_EQ(3u, buffer.push(src));
+        EXPECT_EQ(3u, buffer.size());
+        EXPECT_EQ(3u, buffer.pop(dst));
+        EXPECT_EQ(src, dst);
+    }
+
+    EXPECT_EQ(0u, buffer.size());
+    EXPECT_EQ(0u, buffer.underruns());
+    EXPECT_EQ(0u, buffer.overruns());
+}
+
+TEST(AudioRingBuffer, drops_and_counts_samples_that_dont_fit) {
+    AudioRingBuffer buffer(4);
+    const std::array<int16_t, 3> src{1, 2, 3};
+
+    EXPECT_EQ(3u, buffer.push(src));
+    EXPECT_EQ(1u, buffer.push(src));
+
+    EXPECT_EQ(4u, buffer.size());
+    EXPECT_EQ(2u, buffer.overruns());
+
+    std::array<int16_t, 4> dst{};
+    buffer.pop(dst);
+    EXPECT_EQ((std::array<int16_t, 4>{1, 2, 3, 1}), dst);
+}
+
+TEST(AudioRingBuffer, pads_with_silence_and_counts_missing_samples) {
+    AudioRingBuffer buffer(4);
+    const std::array<int16_t, 2> src{1, 2};
+    buffer.push(src);
+
+    std::array<int16_t, 4> dst{9, 9, 9, 9};
+    EXPECT_EQ(2u, buffer.pop(dst));
+
+    EXPECT_EQ((std::array<int16_t, 4>{1, 2, 0, 0}), dst);
+    EXPECT_EQ(2u, buffer.underruns());
+}
+
+TEST(AudioRingBuffer, rate_control_steers_towards_the_target_size) {
+    AudioRingBuffer buffer(1024);
+    const std::vector<int16_t> half(512);
+
+    // Empty, so produce faster.
+    EXPECT_EQ(48240u, buffer.adjusted_sample_rate(48000, 512));
+
+    buffer.push(half);
+    EXPECT_EQ(48000u, buffer.adjusted_sample_rate(48000, 512));
+
+    // Full, so produce slower.
+    buffer.push(half);
+    EXPECT_EQ(47760u, buffer.adjusted_sample_rate(48000, 512));
+    EXPECT_EQ(47520u, buffer.adjusted_sample_rate(48000, 512, 0.01));
+}
+
+TEST(AudioRingBuffer, hands_samples_between_threads) {
+    constexpr int kSamples{100000};
+    AudioRingBuffer buffer(256);
+
+    std::thread producer([&] {
+        int next = 0;
+        while (next < kSamples) {
+            std::array<int16_t, 100> block{};
+            for (int16_t &sample : block) {
+                sample = static_cast<int16_t>(next++);
+            }
+
+            std::span<const int16_t> left(block);
+            while (!left.empty()) {
+                left = left.subspan(buffer.push(left));
+            }
+        }
+    });
+
+    std::vector<int16_t> received;
+    while (received.size() < kSamples) {
+        std::array<int16_t, 64> block{};
+        const std::size_t count = buffer.pop(
+                std::span(block).first(std::min(block.size(), buffer.size())));
+        received.insert(received.end(),
+                block.begin(),
+                block.begin() + static_cast<std::ptrdiff_t>(count));
+    }
+    producer.join();
+
+    for (std::size_t i = 0; i < received.size(); ++i) {
+        ASSERT_EQ(static_cast<int16_t>(i), received[i]);
+    }
+    EXPECT_EQ(0u, buffer.underruns());
+}
+
+} // namespace
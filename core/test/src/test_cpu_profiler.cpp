@@ -0,0 +1,105 @@
+#include "nes/core/cpu_profiler.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+
+using namespace n_e_s::core;
+
+namespace {
+
+class CpuProfilerTest : public ::testing::Test {
+public:
+    // Feeds the profiler the states of an instruction taking cycles cycles.
+    void run(uint8_t opcode, uint16_t pc, uint64_t cycles) {
+        state.current_opcode = decode(opcode);
+        state.start_pc = pc;
+        state.start_cycle = state.cycle;
+        for (uint64_t i = 0; i < cycles; ++i) {
+            ++state.cycle;
+            profiler.sample(state);
+        }
+    }
+
+    CpuProfiler profiler;
+    CpuState state;
+};
+
+TEST_F(CpuProfilerTest, counts_instruction_once_next_one_is_decoded) {
+    run(LdaImmediate, 0x8000, 2);
+    EXPECT_EQ(0u, profiler.opcode(LdaImmediate).executions);
+
+    run(NopImplied, 0x8002, 2);
+    EXPECT_EQ(1u, profiler.opcode(LdaImmediate).executions);
+    EXPECT_EQ(2u, profiler.opcode(LdaImmediate).cycles);
+    EXPECT_EQ(1u, profiler.address_mode(AddressMode::Immediate).executions);
+    EXPECT_EQ(2u, profiler.pc(0x8000).cycles);
+    EXPECT_EQ(0u, profiler.opcode(NopImplied).executions);
+}
+
+TEST_F(CpuProfilerTest, reports_loops_with_most_cycles_first) {
+    // 0x8000: LDA $2002, 0x8003: BPL $8000
+    for (int i = 0; i < 3; ++i) {
+        run(LdaAbsolute, 0x8000, 4);
+        run(BplRelative, 0x8003, 3);
+    }
+    // 0x9000: JMP $9000
+    run(JmpAbsolute, 0x9000, 3);
+    run(JmpAbsolute, 0x9000, 3);
+    run(NopImplied, 0x9003, 2);
+
+    const auto loops = profiler.hot_loops(5);
+    ASSERT_EQ(2u, loops.size());
+
+    EXPECT_EQ(0x8000, loops[0].start_pc);
+    EXPECT_EQ(0x8003, loops[0].end_pc);
+    EXPECT_EQ(2u, loops[0].iterations);
+    EXPECT_EQ(21u, loops[0].cycles);
+
+    EXPECT_EQ(0x9000, loops[1].start_pc);
+    EXPECT_EQ(0x9000, loops[1].end_pc);
+    EXPECT_EQ(1u, loops[1].iterations);
+    EXPECT_EQ(6u, loops[1].cycles);
+
+    EXPECT_EQ(1u, profiler.hot_loops(1).size());
+}
+
+TEST_F(CpuProfilerTest, forward_branches_are_not_loops) {
+    run(BneRelative, 0x8000, 3);
+    run(NopImplied, 0x8010, 2);
+
+    EXPECT_TRUE(profiler.hot_loops(5).empty());
+}
+
+TEST_F(CpuProfilerTest, writes_csv) {
+    run(LdaImmediate, 0x8000, 2);
+    run(JmpAbsolute, 0x8002, 3);
+    run(LdaImmediate, 0x8000, 2);
+
+    std::stringstream ss;
+    profiler.write_csv(ss);
+
+    EXPECT_EQ(
+            "kind,key,executions,cycles\n"
+            "opcode,0x4c JMP Absolute,1,3\n"
+            "opcode,0xa9 LDA Immediate,1,2\n"
+            "address_mode,Immediate,1,2\n"
+            "address_mode,Absolute,1,3\n"
+            "pc,0x8000,1,2\n"
+            "pc,0x8002,1,3\n"
+            "loop,0x8000-0x8002,1,5\n",
+            ss.str());
+}
+
+TEST_F(CpuProfilerTest, clear_resets_all_counters) {
+    run(JmpAbsolute, 0x8000, 3);
+    run(JmpAbsolute, 0x8000, 3);
+    profiler.clear();
+
+    EXPECT_EQ(0u, profiler.opcode(JmpAbsolute).executions);
+    EXPECT_EQ(0u, profiler.pc(0x8000).executions);
+    EXPECT_TRUE(profiler.hot_loops(5).empty());
+}
+
+} // namespace
@@ -1,4 +1,5 @@
 #include "nes/core/cpu_factory.h"
+#include "nes/core/trace.h"
 
 #include "icpu_helpers.h"
 #include "nes/core/test/fake_mmu.h"
@@ -6,6 +7,12 @@
 
 #include <gtest/gtest.h>
 
+#include <array>
+#include <optional>
+#include <span>
+#include <sstream>
+#include <string>
+
 using namespace n_e_s::core;
 using namespace n_e_s::core::test;
 
@@ -312,4 +319,472 @@ TEST_F(CpuIntegrationTest, nmi) {
     EXPECT_EQ(expected, registers);
 }
 
+TEST_F(CpuIntegrationTest, irq_is_delayed_by_cli) {
+    // Address  Hexdump   Dissassembly
+    // -------------------------------
+    // $0600    58        CLI
+    // $0601    e8        INX
+    // $0602    e8        INX
+    // irq:
+    // $1000    c8        INY
+    load_hex_dump(0x0600, {0x58, 0xe8, 0xe8, 0x00});
+    load_hex_dump(0x1000, {0xc8, 0x00});
+    set_reset_address(0x0600);
+    set_break_address(0x1000);
+    registers.p = I_FLAG | FLAG_5;
+
+    cpu->reset();
+    cpu->set_irq(IRQ_MAPPER, true);
+
+    step_execution(2 + 2 + 7); // cli + inx + irq
+    EXPECT_EQ(0x1000, registers.pc);
+    EXPECT_EQ(0x01, registers.x);
+    EXPECT_EQ(I_FLAG | FLAG_5, registers.p);
+
+    // The return address and the status without the B flag are pushed.
+    EXPECT_EQ(0x06, mmu.read_byte(kStackOffset + 0xFF));
+    EXPECT_EQ(0x02, mmu.read_byte(kStackOffset + 0xFE));
+    EXPECT_EQ(FLAG_5, mmu.read_byte(kStackOffset + 0xFD));
+}
+
+TEST_F(CpuIntegrationTest, irq_is_ignored_while_interrupts_are_disabled) {
+    load_hex_dump(0x0600, {0xe8, 0xe8, 0xe8, 0x00});
+    set_reset_address(0x0600);
+    registers.p = I_FLAG | FLAG_5;
+
+    cpu->reset();
+    cpu->set_irq(IRQ_APU_FRAME_COUNTER, true);
+
+    step_execution(2 * 3);
+    EXPECT_EQ(0x03, registers.x);
+    EXPECT_EQ(IRQ_APU_FRAME_COUNTER, cpu->irq_sources());
+}
+
+TEST_F(CpuIntegrationTest, irq_asserted_during_sei_is_taken_after_it) {
+    // $0600    78        SEI
+    // $0601    e8        INX
+    load_hex_dump(0x0600, {0x78, 0xe8, 0x00});
+    load_hex_dump(0x1000, {0xc8, 0x00});
+    set_reset_address(0x0600);
+    set_break_address(0x1000);
+    registers.p = FLAG_5;
+
+    cpu->reset();
+    step_execution(1);
+    cpu->set_irq(IRQ_APU_DMC, true);
+
+    step_execution(1 + 7); // sei + irq
+    EXPECT_EQ(0x1000, registers.pc);
+    EXPECT_EQ(0x00, registers.x);
+    EXPECT_EQ(I_FLAG | FLAG_5, mmu.read_byte(kStackOffset + 0xFD));
+}
+
+TEST_F(CpuIntegrationTest, irq_line_is_held_until_all_sources_release_it) {
+    load_hex_dump(0x0600, {0xe8, 0xe8, 0xe8, 0xe8, 0x00});
+    load_hex_dump(0x1000, {0xc8, 0x00});
+    set_reset_address(0x0600);
+    set_break_address(0x1000);
+    registers.p = FLAG_5;
+
+    cpu->set_irq(IRQ_MAPPER | IRQ_APU_FRAME_COUNTER, true);
+    cpu->set_irq(IRQ_MAPPER, false);
+    EXPECT_EQ(IRQ_APU_FRAME_COUNTER, cpu->irq_sources());
+
+    cpu->set_irq(IRQ_APU_FRAME_COUNTER, false);
+    EXPECT_EQ(0u, cpu->irq_sources());
+
+    cpu->reset();
+    step_execution(2 * 4);
+    EXPECT_EQ(0x04, registers.x);
+}
+
+TEST_F(CpuIntegrationTest, scheduled_irq_is_taken_at_next_boundary) {
+    load_hex_dump(0x0600, {0xe8, 0xe8, 0xe8, 0xe8, 0xe8, 0x00});
+    load_hex_dump(0x1000, {0xc8, 0x00});
+    set_reset_address(0x0600);
+    set_break_address(0x1000);
+    registers.p = FLAG_5;
+
+    cpu->reset();
+    cpu->schedule_irq(IRQ_APU_FRAME_COUNTER, 7);
+
+    step_execution(2 * 4 + 7); // inx * 4 + irq
+    EXPECT_EQ(0x1000, registers.pc);
+    EXPECT_EQ(0x04, registers.x);
+    EXPECT_EQ(IRQ_APU_FRAME_COUNTER, cpu->irq_sources());
+}
+
+TEST_F(CpuIntegrationTest, releasing_irq_cancels_schedule) {
+    load_hex_dump(0x0600, {0xe8, 0xe8, 0xe8, 0xe8, 0x00});
+    set_reset_address(0x0600);
+    registers.p = FLAG_5;
+
+    cpu->reset();
+    cpu->schedule_irq(IRQ_MAPPER, 3);
+    cpu->set_irq(IRQ_MAPPER, false);
+
+    step_execution(2 * 4);
+    EXPECT_EQ(0x04, registers.x);
+    EXPECT_EQ(0u, cpu->irq_sources());
+}
+
+TEST_F(CpuIntegrationTest, dma_stalls_the_cpu_for_4_cycles) {
+    load_hex_dump(0x0600, {0xe8, 0xe8, 0xe8, 0xe8, 0x00});
+    set_reset_address(0x0600);
+    registers.p = FLAG_5;
+    int dmas = 0;
+    cpu->set_dma_handler([&] { ++dmas; });
+
+    cpu->reset();
+    cpu->schedule_dma(cpu->state().cycle + 2);
+
+    step_execution(2 * 2 + 4); // inx * 2 + dma
+    EXPECT_EQ(0x02, registers.x);
+    EXPECT_EQ(1, dmas);
+
+    step_execution(2 * 2);
+    EXPECT_EQ(0x04, registers.x);
+    EXPECT_EQ(1, dmas);
+}
+
+TEST_F(CpuIntegrationTest, dma_can_be_cancelled) {
+    load_hex_dump(0x0600, {0xe8, 0xe8, 0xe8, 0xe8, 0x00});
+    set_reset_address(0x0600);
+    registers.p = FLAG_5;
+    int dmas = 0;
+    cpu->set_dma_handler([&] { ++dmas; });
+
+    cpu->reset();
+    cpu->schedule_dma(cpu->state().cycle + 2);
+    cpu->schedule_dma(std::nullopt);
+
+    step_execution(2 * 4);
+    EXPECT_EQ(0x04, registers.x);
+    EXPECT_EQ(0, dmas);
+}
+
+TEST_F(CpuIntegrationTest, traces_one_scope_per_instruction) {
+    load_hex_dump(0x0600, {0xe8, 0xe8, 0xe8, 0x00});
+    set_reset_address(0x0600);
+    cpu->reset();
+    Trace::clear();
+
+    Trace::enable(true);
+    step_execution(2 * 3); // inx * 3
+    Trace::enable(false);
+    step_execution(1);
+
+    std::stringstream ss;
+    Trace::write_json(ss);
+    Trace::clear();
+    const std::string json = ss.str();
+    const auto count = [&json](const std::string &event) {
+        int n = 0;
+        for (std::size_t pos = json.find(event); pos != std::string::npos;
+                pos = json.find(event, pos + 1)) {
+            ++n;
+        }
+        return n;
+    };
+    EXPECT_EQ(3, count(R"("ph":"B")"));
+    EXPECT_EQ(3, count(R"("ph":"E")"));
+}
+
+// Lets the cpu access zeropage and the stack directly. Those addresses can't be
+// read or written through the mmu functions.
+class DirectRamMmu : public FakeMmu {
+public:
+    uint8_t read_byte(uint16_t addr) const override {
+        EXPECT_GE(addr, ram.size());
+        return FakeMmu::read_byte(addr);
+    }
+
+    void write_byte(uint16_t addr, uint8_t byte) override {
+        EXPECT_GE(addr, ram.size());
+        FakeMmu::write_byte(addr, byte);
+    }
+
+    std::span<uint8_t> direct_memory(uint16_t addr) override {
+        if (addr >= ram.size()) {
+            return {};
+        }
+        return std::span(ram).subspan(addr);
+    }
+
+    uint8_t *open_bus() override {
+        return &bus;
+    }
+
+    std::array<uint8_t, 0x200> ram{};
+    uint8_t bus{};
+};
+
+TEST(CpuDirectRamTest, zeropage_and_stack_bypass_the_mmu) {
+    // $8000    a9 42     LDA #$42
+    // $8002    85 10     STA $10
+    // $8004    48        PHA
+    // $8005    a6 10     LDX $10
+    // $8007    68        PLA
+    // $8008    a1 0e     LDA ($0E,X)
+    DirectRamMmu mmu;
+    const std::vector<uint8_t> program{
+            0xa9, 0x42, 0x85, 0x10, 0x48, 0xa6, 0x10, 0x68, 0xa1, 0x0e, 0x00};
+    for (uint16_t i = 0; i < program.size(); ++i) {
+        mmu.FakeMmu::write_byte(0x8000 + i, program[i]);
+    }
+    mmu.FakeMmu::write_byte(kResetAddress, 0x00);
+    mmu.FakeMmu::write_byte(kResetAddress + 1, 0x80);
+    mmu.FakeMmu::write_byte(0x9000, 0x99);
+    mmu.ram[0x50] = 0x00;
+    mmu.ram[0x51] = 0x90;
+
+    CpuRegisters registers{};
+    registers.sp = 0xFF;
+    FakePpu ppu;
+    auto cpu = CpuFactory::create_mos6502(&registers, &mmu, &ppu);
+    cpu->reset();
+    for (int i = 0; i < 2 + 3 + 3 + 3 + 4 + 6; ++i) {
+        cpu->execute();
+    }
+
+    EXPECT_EQ(0x42, mmu.ram[0x10]);
+    EXPECT_EQ(0x42, mmu.ram[0x1FF]);
+    EXPECT_EQ(0x42, registers.x);
+    EXPECT_EQ(0xFF, registers.sp);
+    EXPECT_EQ(0x99, registers.a);
+}
+
+TEST(CpuDirectRamTest, direct_accesses_update_the_open_bus) {
+    // $8000    a9 42     LDA #$42
+    // $8002    85 10     STA $10
+    // $8004    a5 11     LDA $11
+    // $8006    48        PHA
+    DirectRamMmu mmu;
+    const std::vector<uint8_t> program{
+            0xa9, 0x42, 0x85, 0x10, 0xa5, 0x11, 0x48, 0x00};
+    for (uint16_t i = 0; i < program.size(); ++i) {
+        mmu.FakeMmu::write_byte(0x8000 + i, program[i]);
+    }
+    mmu.FakeMmu::write_byte(kResetAddress, 0x00);
+    mmu.FakeMmu::write_byte(kResetAddress + 1, 0x80);
+    mmu.ram[0x11] = 0x37;
+
+    CpuRegisters registers{};
+    registers.sp = 0xFF;
+    FakePpu ppu;
+    auto cpu = CpuFactory::create_mos6502(&registers, &mmu, &ppu);
+    cpu->reset();
+    for (int i = 0; i < 2 + 3; ++i) {
+        cpu->execute();
+    }
+    EXPECT_EQ(0x42, mmu.bus);
+
+    for (int i = 0; i < 3; ++i) {
+        cpu->execute();
+    }
+    EXPECT_EQ(0x37, mmu.bus);
+
+    mmu.bus = 0x00;
+    for (int i = 0; i < 3; ++i) {
+        cpu->execute();
+    }
+    EXPECT_EQ(0x37, mmu.ram[0x1FF]);
+    EXPECT_EQ(0x37, mmu.bus);
+}
+
+// Runs the same program on a cpu with idle loop detection and on one without
+// and checks that they're identical at every instruction boundary.
+class IdleLoopTest : public ::testing::Test {
+public:
+    struct System {
+        System() {
+            registers.sp = 0xFF;
+        }
+
+        CpuRegisters registers{};
+        FakeMmu mmu;
+        FakePpu ppu;
+        std::unique_ptr<IMos6502> cpu{
+                CpuFactory::create_mos6502(&registers, &mmu, &ppu)};
+    };
+
+    IdleLoopTest() {
+        accurate.cpu->set_idle_loop_detection(false);
+        write_word(kResetAddress, 0x8000);
+        write_word(kNmiAddress, 0x9000);
+    }
+
+    void load_hex_dump(uint16_t address, const std::vector<uint8_t> &data) {
+        for (auto d : data) {
+            fast.mmu.write_byte(address, d);
+            accurate.mmu.write_byte(address++, d);
+        }
+    }
+
+    void write_word(uint16_t address, uint16_t value) {
+        load_hex_dump(address,
+                {static_cast<uint8_t>(value & 0xFFu),
+                        static_cast<uint8_t>(value >> 8u)});
+    }
+
+    // Calls before_cycle with each system before every cycle.
+    void run(int cycles,
+            const std::function<void(System &, int)> &before_cycle) {
+        fast.cpu->reset();
+        accurate.cpu->reset();
+
+        for (int i = 0; i < cycles; ++i) {
+            before_cycle(fast, i);
+            before_cycle(accurate, i);
+            fast.cpu->execute();
+            accurate.cpu->execute();
+
+            const CpuState &expected = accurate.cpu->state();
+            const CpuState &actual = fast.cpu->state();
+            ASSERT_EQ(expected.start_pc, actual.start_pc) << "cycle " << i;
+            ASSERT_EQ(expected.start_cycle, actual.start_cycle);
+            ASSERT_EQ(expected.current_opcode->instruction,
+                    actual.current_opcode->instruction);
+            if (actual.start_cycle + 1 == actual.cycle) {
+                // Just decoded a new instruction.
+                ASSERT_EQ(accurate.registers, fast.registers) << "cycle " << i;
+            }
+        }
+    }
+
+    System fast;
+    System accurate;
+};
+
+TEST_F(IdleLoopTest, jump_to_self_until_nmi) {
+    // $8000    4c 00 80  JMP $8000
+    // nmi:
+    // $9000    e8        INX
+    // $9001    40        RTI
+    load_hex_dump(0x8000, {0x4c, 0x00, 0x80});
+    load_hex_dump(0x9000, {0xe8, 0x40, 0x00});
+
+    run(300, [](System &system, int cycle) {
+        if (cycle == 100 || cycle == 201) {
+            system.cpu->set_nmi(true);
+        }
+    });
+
+    EXPECT_EQ(0x02, fast.registers.x);
+}
+
+TEST_F(IdleLoopTest, jump_to_self_until_irq) {
+    // $8000    58        CLI
+    // $8001    4c 01 80  JMP $8001
+    // irq:
+    // $9800    e8        INX
+    // $9801    40        RTI
+    load_hex_dump(0x8000, {0x58, 0x4c, 0x01, 0x80});
+    load_hex_dump(0x9800, {0xe8, 0x40, 0x00});
+    write_word(kBrkAddress, 0x9800);
+
+    run(300, [](System &system, int cycle) {
+        if (cycle == 100) {
+            system.cpu->set_irq(IRQ_MAPPER, true);
+        } else if (cycle == 110) {
+            system.cpu->set_irq(IRQ_MAPPER, false);
+        } else if (cycle == 200) {
+            system.cpu->schedule_irq(IRQ_APU_FRAME_COUNTER, 250);
+        } else if (cycle == 260) {
+            system.cpu->set_irq(IRQ_APU_FRAME_COUNTER, false);
+        }
+    });
+
+    EXPECT_EQ(0x02, fast.registers.x);
+}
+
+TEST_F(IdleLoopTest, poll_until_negative) {
+    // $8000    ad 02 20  LDA $2002
+    // $8003    10 fb     BPL $8000
+    // $8005    e8        INX
+    // $8006    4c 06 80  JMP $8006
+    load_hex_dump(0x8000,
+            {0xad, 0x02, 0x20, 0x10, 0xfb, 0xe8, 0x4c, 0x06, 0x80});
+    load_hex_dump(0x2002, {0x00});
+
+    run(300, [](System &system, int cycle) {
+        if (cycle == 150) {
+            system.mmu.write_byte(0x2002, 0x80);
+        }
+    });
+
+    EXPECT_EQ(0x80, fast.registers.a);
+    EXPECT_EQ(0x01, fast.registers.x);
+}
+
+TEST_F(IdleLoopTest, poll_with_bit_and_nmi) {
+    // $8000    2c 02 20  BIT $2002
+    // $8003    50 fb     BVC $8000
+    // $8005    4c 05 80  JMP $8005
+    // nmi:
+    // $9000    c8        INY
+    // $9001    40        RTI
+    load_hex_dump(0x8000, {0x2c, 0x02, 0x20, 0x50, 0xfb, 0x4c, 0x05, 0x80});
+    load_hex_dump(0x9000, {0xc8, 0x40, 0x00});
+    load_hex_dump(0x2002, {0x00});
+
+    run(400, [](System &system, int cycle) {
+        if (cycle == 103) {
+            system.cpu->set_nmi(true);
+        }
+        if (cycle == 304) {
+            system.mmu.write_byte(0x2002, 0x40);
+        }
+    });
+
+    EXPECT_EQ(0x01, fast.registers.y);
+    EXPECT_EQ(0x8005, fast.cpu->state().start_pc);
+}
+
+TEST_F(IdleLoopTest, zeropage_poll_across_page_boundary) {
+    // $80fd    a6 10     LDX $10
+    // $80ff    f0 fc     BEQ $80fd
+    // $8101    4c 01 81  JMP $8101
+    write_word(kResetAddress, 0x80fd);
+    load_hex_dump(0x80fd, {0xa6, 0x10, 0xf0, 0xfc, 0x4c, 0x01, 0x81});
+    load_hex_dump(0x0010, {0x00});
+
+    run(200, [](System &system, int cycle) {
+        if (cycle == 97) {
+            system.mmu.write_byte(0x0010, 0x05);
+        }
+    });
+
+    EXPECT_EQ(0x05, fast.registers.x);
+}
+
+TEST_F(IdleLoopTest, can_be_disabled_while_in_loop) {
+    load_hex_dump(0x8000, {0x4c, 0x00, 0x80});
+
+    run(100, [](System &system, int cycle) {
+        if (cycle == 50) {
+            system.cpu->set_idle_loop_detection(false);
+        }
+    });
+}
+
+TEST_F(IdleLoopTest, instruction_bytes_are_not_fetched_in_loop) {
+    // $8000    a5 10     LDA $10
+    // $8002    30 fc     BMI $8000
+    load_hex_dump(0x8000, {0xa5, 0x10, 0x30, 0xfc});
+    load_hex_dump(0x0010, {0x80});
+    fast.cpu->reset();
+    for (int i = 0; i < 20; ++i) {
+        fast.cpu->execute();
+    }
+
+    // Any fetch of these would be reported as bad instructions.
+    fast.mmu.write_byte(0x8000, 0x02);
+    fast.mmu.write_byte(0x8002, 0x02);
+    for (int i = 0; i < 100; ++i) {
+        fast.cpu->execute();
+    }
+    EXPECT_EQ(0x8002, fast.cpu->state().start_pc);
+}
+
 } // namespace
@@ -13,6 +13,88 @@ TEST(INesHeader, returns_correct_mapper) {
     EXPECT_EQ(0b1010'0011, h.mapper());
 }
 
+TEST(INesHeader, ignores_upper_mapper_nibble_with_garbage_in_padding) {
+    INesHeader h;
+    h.flags_6 = 0b0011'0000;
+    h.flags_7 = 0b1010'0000;
+    h.flags_12 = 'D';
+    EXPECT_EQ(0b0000'0011, h.mapper());
+}
+
+TEST(INesHeader, returns_nes2_mapper_and_submapper) {
+    INesHeader h;
+    h.flags_6 = 0b0011'0000;
+    h.flags_7 = 0b1010'1000;
+    h.flags_8 = 0b0101'0001;
+    EXPECT_TRUE(h.is_nes2());
+    EXPECT_EQ(0x1A3, h.mapper());
+    EXPECT_EQ(5, h.submapper());
+}
+
+TEST(INesHeader, returns_rom_sizes) {
+    INesHeader h;
+    h.prg_rom_size = 2;
+    h.chr_rom_size = 1;
+    h.flags_7 = 0x00;
+    h.flags_9 = 0x21; // Only used by NES 2.0.
+    EXPECT_EQ(32u * 1024u, h.prg_rom_bytes());
+    EXPECT_EQ(8u * 1024u, h.chr_rom_bytes());
+
+    h.flags_7 = 0x08;
+    EXPECT_EQ(0x102u * 16u * 1024u, h.prg_rom_bytes());
+    EXPECT_EQ(0x201u * 8u * 1024u, h.chr_rom_bytes());
+
+    // Exponent-multiplier notation, 2^4 * (1 * 2 + 1).
+    h.prg_rom_size = 0b0001'0001;
+    h.flags_9 = 0x0F;
+    EXPECT_EQ(48u, h.prg_rom_bytes());
+}
+
+TEST(INesHeader, returns_ines_ram_sizes) {
+    INesHeader h;
+    h.chr_rom_size = 0;
+    h.flags_6 = 0x02;
+    h.flags_7 = 0x00;
+    h.flags_8 = 0;
+    EXPECT_EQ(8u * 1024u, h.prg_ram_bytes());
+    EXPECT_EQ(8u * 1024u, h.prg_nvram_bytes());
+    EXPECT_EQ(8u * 1024u, h.chr_ram_bytes());
+
+    h.flags_8 = 4;
+    EXPECT_EQ(32u * 1024u, h.prg_ram_bytes());
+}
+
+TEST(INesHeader, returns_nes2_ram_sizes) {
+    INesHeader h;
+    h.chr_rom_size = 0;
+    h.flags_6 = 0x02;
+    h.flags_7 = 0x08;
+    h.flags_10 = 0x70;
+    h.flags_11 = 0x09;
+    EXPECT_EQ(0u, h.prg_ram_bytes());
+    EXPECT_EQ(8u * 1024u, h.prg_nvram_bytes());
+    EXPECT_EQ(32u * 1024u, h.chr_ram_bytes());
+}
+
+TEST(INesHeader, returns_timing) {
+    INesHeader h;
+    h.flags_7 = 0x00;
+    h.flags_9 = 0x01;
+    EXPECT_EQ(Timing::Pal, h.timing());
+
+    h.flags_7 = 0x08;
+    h.flags_12 = 0x03;
+    EXPECT_EQ(Timing::Dendy, h.timing());
+}
+
+TEST(INesHeader, returns_battery_flag) {
+    INesHeader h;
+    h.flags_6 = 0x00;
+    EXPECT_FALSE(h.has_battery());
+    h.flags_6 = 0x02;
+    EXPECT_TRUE(h.has_battery());
+}
+
 TEST(INesHeader, returns_horizonal_mirroring) {
     INesHeader h;
     h.flags_6 = 0x00;
@@ -23,5 +105,10 @@ TEST(INesHeader, returns_vertical_mirroring) {
     h.flags_6 = 0x01;
     EXPECT_EQ(Mirroring::Vertical, h.mirroring());
 }
+TEST(INesHeader, returns_four_screen_mirroring) {
+    INesHeader h;
+    h.flags_6 = 0x09;
+    EXPECT_EQ(Mirroring::FourScreen, h.mirroring());
+}
 
 } // namespace
@@ -6,10 +6,12 @@
 
 #include "mock_irom.h"
 #include "mock_nes_controller.h"
+#include "nes/core/test/mock_apu.h"
 #include "nes/core/test/mock_membank.h"
 #include "nes/core/test/mock_ppu.h"
 
 #include <gtest/gtest.h>
+#include <array>
 #include <memory>
 
 using namespace n_e_s::core;
@@ -18,18 +20,20 @@ using namespace n_e_s::core::test;
 namespace {
 
 std::vector<uint16_t> get_addr_list() {
-    return {0x0000, 0x1000, 0x4000};
+    return {0x0000, 0x1000, 0x4020};
 }
 
 class NesMmuTest : public ::testing::Test {
 public:
     MockPpu ppu{};
+    ::testing::StrictMock<MockApu> apu{};
     testing::NiceMock<MockIRom> rom{};
     ::testing::StrictMock<MockNesController> controller1{};
     ::testing::StrictMock<MockNesController> controller2{};
 
     std::unique_ptr<IMmu> mmu{
             MmuFactory::create(MemBankFactory::create_nes_mem_banks(&ppu,
+                    &apu,
                     &rom,
                     &controller1,
                     &controller2))};
@@ -65,6 +69,45 @@ TEST_F(NesMmuTest, read_write_byte_to_ppu_mirrored) {
     EXPECT_EQ(0xCD, mmu->read_byte(0x3000));
 }
 
+TEST_F(NesMmuTest, read_write_byte_to_apu) {
+    EXPECT_CALL(apu, write_byte(0x4000, 0xAB));
+    EXPECT_CALL(apu, write_byte(0x4013, 0xCD));
+    EXPECT_CALL(apu, write_byte(0x4015, 0x0F));
+    EXPECT_CALL(apu, read_byte(0x4015)).WillOnce(testing::Return(0x4F));
+
+    mmu->write_byte(0x4000, 0xAB);
+    mmu->write_byte(0x4013, 0xCD);
+    mmu->write_byte(0x4015, 0x0F);
+    EXPECT_EQ(0x4F, mmu->read_byte(0x4015));
+}
+
+TEST_F(NesMmuTest, sprite_dma_writes_are_accepted) {
+    mmu->set_strict(true);
+
+    EXPECT_NO_THROW(mmu->write_byte(0x4014, 0x02));
+    EXPECT_EQ(0u, mmu->invalid_access_count());
+}
+
+TEST_F(NesMmuTest, write_only_apu_registers_read_open_bus) {
+    mmu->write_byte(0x0010, 0x5A);
+    EXPECT_EQ(0x5A, mmu->read_byte(0x4000));
+    EXPECT_EQ(0x5A, mmu->read_byte(0x4014));
+    EXPECT_EQ(0x5A, mmu->peek_byte(0x4013));
+    EXPECT_EQ(0u, mmu->invalid_access_count());
+}
+
+TEST_F(NesMmuTest, frame_counter_writes_go_to_apu) {
+    EXPECT_CALL(apu, write_byte(0x4017, 0x40));
+
+    mmu->write_byte(0x4017, 0x40);
+}
+
+TEST_F(NesMmuTest, peeking_apu_status_does_not_read_it) {
+    EXPECT_CALL(apu, peek_byte(0x4015)).WillOnce(testing::Return(0x40));
+
+    EXPECT_EQ(0x40, mmu->peek_byte(0x4015));
+}
+
 TEST_F(NesMmuTest, read_write_byte_io_dev_bank) {
     mmu->write_byte(0x4018, 0x33);
     EXPECT_EQ(0x33, mmu->read_byte(0x4018));
@@ -83,12 +126,136 @@ TEST_F(NesMmuTest, ram_bank_mirroring) {
     }
 }
 
-TEST_F(MmuTest, read_byte_invalid_address) {
+TEST_F(NesMmuTest, ram_allows_direct_access) {
+    const std::span<uint8_t> ram = mmu->direct_memory(0x0000);
+    ASSERT_EQ(0x800u, ram.size());
+
+    ram[0x1FF] = 0x42;
+    EXPECT_EQ(0x42, mmu->read_byte(0x01FF));
+    EXPECT_EQ(0x42, mmu->read_byte(0x09FF));
+
+    mmu->write_byte(0x0010, 0x24);
+    EXPECT_EQ(0x24, ram[0x10]);
+    EXPECT_EQ(0x24, mmu->direct_memory(0x0810)[0]);
+}
+
+TEST_F(NesMmuTest, io_does_not_allow_direct_access) {
+    EXPECT_TRUE(mmu->direct_memory(0x2000).empty());
+    EXPECT_TRUE(mmu->direct_memory(0x4016).empty());
+}
+
+TEST_F(NesMmuTest, read_write_block_ram_mirrored) {
+    const std::array<uint8_t, 4> bytes{0x01, 0x02, 0x03, 0x04};
+    mmu->write_block(0x07FE, bytes);
+
+    EXPECT_EQ(0x02, mmu->read_byte(0x07FF));
+    EXPECT_EQ(0x03, mmu->read_byte(0x0000));
+
+    std::array<uint8_t, 4> result{};
+    mmu->read_block(0x17FE, result);
+    EXPECT_EQ(bytes, result);
+}
+
+TEST_F(NesMmuTest, read_block_across_mem_banks) {
+    EXPECT_CALL(ppu, read_byte(0x2000)).WillOnce(testing::Return(0x24));
+    EXPECT_CALL(ppu, read_byte(0x2001)).WillOnce(testing::Return(0x25));
+    mmu->write_byte(0x1FFF, 0x42);
+
+    std::array<uint8_t, 3> result{};
+    mmu->read_block(0x1FFF, result);
+    EXPECT_EQ((std::array<uint8_t, 3>{0x42, 0x24, 0x25}), result);
+}
+
+TEST_F(NesMmuTest, peek_block_has_no_side_effects) {
+    EXPECT_CALL(ppu, read_byte(testing::_)).Times(0);
+    EXPECT_CALL(controller1, get(INesController::Button::A))
+            .WillRepeatedly(testing::Return(true));
+    mmu->write_byte(0x1FFF, 0x42);
+
+    std::array<uint8_t, 3> ppu_bytes{};
+    mmu->peek_block(0x1FFF, ppu_bytes);
+    EXPECT_EQ((std::array<uint8_t, 3>{0x42, 0x00, 0x00}), ppu_bytes);
+
+    std::array<uint8_t, 1> controller_byte{};
+    mmu->peek_block(0x4016, controller_byte);
+    mmu->peek_block(0x4016, controller_byte);
+    EXPECT_EQ(0x41, controller_byte[0]);
+
+    // The peeks didn't advance the controller, so this is still button A.
+    EXPECT_EQ(0x41, mmu->read_byte(0x4016));
+}
+
+TEST_F(NesMmuTest, peek_byte_has_no_side_effects) {
+    EXPECT_CALL(ppu, read_byte(testing::_)).Times(0);
+    EXPECT_CALL(controller2, get(INesController::Button::A))
+            .WillRepeatedly(testing::Return(false));
+    mmu->write_byte(0x0123, 0x42);
+
+    EXPECT_EQ(0x42, mmu->peek_byte(0x0923));
+    EXPECT_EQ(0x00, mmu->peek_byte(0x2002));
+    EXPECT_EQ(0x40, mmu->peek_byte(0x4017));
+    EXPECT_EQ(0x40, mmu->peek_byte(0x4017));
+
+    // The peeks didn't advance the controller, so this is still button A.
+    EXPECT_EQ(0x40, mmu->read_byte(0x4017));
+}
+
+TEST_F(MmuTest, peek_byte_invalid_address) {
+    mmu->write_byte(0x1234, 0xAB);
+    EXPECT_EQ(0xAB, mmu->peek_byte(0x3333));
+    EXPECT_EQ(1u, mmu->invalid_access_count());
+}
+
+TEST_F(MmuTest, block_invalid_address_wraps_around) {
+    mmu->write_byte(0x1234, 0xAB);
+
+    std::array<uint8_t, 2> result{};
+    mmu->peek_block(0xFFFF, result);
+    EXPECT_EQ((std::array<uint8_t, 2>{0xAB, 0xAB}), result);
+    EXPECT_EQ(1u, mmu->invalid_access_count());
+
+    mmu->read_block(0xFFFF, result);
+    EXPECT_EQ(3u, mmu->invalid_access_count());
+}
+
+TEST_F(MmuTest, direct_memory_invalid_address) {
+    EXPECT_TRUE(mmu->direct_memory(0x0000).empty());
+}
+
+TEST_F(MmuTest, read_byte_invalid_address_strict) {
+    mmu->set_strict(true);
     EXPECT_THROW(mmu->read_byte(0x3333), InvalidAddress);
+    EXPECT_EQ(1u, mmu->invalid_access_count());
 }
 
-TEST_F(MmuTest, write_byte_invalid_address) {
+TEST_F(MmuTest, write_byte_invalid_address_strict) {
+    mmu->set_strict(true);
     EXPECT_THROW(mmu->write_byte(0x1234, 0xFF), InvalidAddress);
+    EXPECT_EQ(1u, mmu->invalid_access_count());
+}
+
+TEST_F(MmuTest, invalid_address_reads_open_bus) {
+    mmu->write_byte(0x1234, 0xAB);
+    EXPECT_EQ(0xAB, mmu->read_byte(0x3333));
+    EXPECT_EQ(0xAB, mmu->read_byte(0x3334));
+    EXPECT_EQ(3u, mmu->invalid_access_count());
+}
+
+TEST_F(MmuTest, open_bus_is_last_byte_read) {
+    auto mem_bank = std::make_unique<MockMemBank>();
+    EXPECT_CALL(*mem_bank, is_address_in_range(testing::_))
+            .WillRepeatedly(testing::Invoke(
+                    [](uint16_t addr) { return addr == 0x2000; }));
+    EXPECT_CALL(*mem_bank, read_byte(0x2000u))
+            .WillOnce(testing::Return(uint8_t{0x42}));
+
+    MemBankList mem_banks;
+    mem_banks.emplace_back(std::move(mem_bank));
+    mmu->set_mem_banks(std::move(mem_banks));
+
+    EXPECT_EQ(0x42, mmu->read_byte(0x2000));
+    EXPECT_EQ(0x42, mmu->read_byte(0x5000));
+    EXPECT_EQ(1u, mmu->invalid_access_count());
 }
 
 TEST_F(MmuTest, set_membanks) {
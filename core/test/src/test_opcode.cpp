@@ -75,4 +75,20 @@ TEST(Opcode, Family) {
     EXPECT_EQ("RRA", to_string(Family::RRA));
 }
 
+TEST(Opcode, AddressMode) {
+    EXPECT_EQ("Implied", to_string(AddressMode::Implied));
+    EXPECT_EQ("Immediate", to_string(AddressMode::Immediate));
+    EXPECT_EQ("Zeropage", to_string(AddressMode::Zeropage));
+    EXPECT_EQ("ZeropageX", to_string(AddressMode::ZeropageX));
+    EXPECT_EQ("ZeropageY", to_string(AddressMode::ZeropageY));
+    EXPECT_EQ("Relative", to_string(AddressMode::Relative));
+    EXPECT_EQ("Absolute", to_string(AddressMode::Absolute));
+    EXPECT_EQ("AbsoluteX", to_string(AddressMode::AbsoluteX));
+    EXPECT_EQ("AbsoluteY", to_string(AddressMode::AbsoluteY));
+    EXPECT_EQ("Accumulator", to_string(AddressMode::Accumulator));
+    EXPECT_EQ("IndexedIndirect", to_string(AddressMode::IndexedIndirect));
+    EXPECT_EQ("IndirectIndexed", to_string(AddressMode::IndirectIndexed));
+    EXPECT_EQ("Indirect", to_string(AddressMode::Indirect));
+}
+
 } // namespace
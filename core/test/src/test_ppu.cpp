@@ -1,11 +1,15 @@
 #include "ippu_helpers.h"
 #include "nes/core/invalid_address.h"
 #include "nes/core/ppu_factory.h"
+#include "nes/core/trace.h"
 
 #include "nes/core/test/mock_mmu.h"
 
 #include <gtest/gtest.h>
 #include <array>
+#include <sstream>
+#include <string>
+#include <vector>
 
 using namespace n_e_s::core;
 using namespace n_e_s::core::test;
@@ -198,6 +202,35 @@ TEST_F(PpuTest, nmi_triggered_when_enabled_during_vblank) {
     ASSERT_FALSE(triggered);
 }
 
+TEST_F(PpuTest, a12_rises_once_per_rendered_scanline) {
+    std::vector<uint16_t> rise_cycles;
+    ppu->set_a12_rise_handler([&] { rise_cycles.push_back(ppu->cycle()); });
+
+    // Sprites in the $1000 pattern table.
+    registers.ctrl = PpuCtrl(0b0000'1000);
+    registers.mask = PpuMask(0b0001'1000);
+    step_execution(kCyclesPerScanline);
+    EXPECT_EQ(std::vector<uint16_t>{260}, rise_cycles);
+
+    // Background in the $1000 pattern table.
+    rise_cycles.clear();
+    registers.ctrl = PpuCtrl(0b0001'0000);
+    step_execution(kCyclesPerScanline);
+    EXPECT_EQ(std::vector<uint16_t>{324}, rise_cycles);
+
+    // No rise when both use the same pattern table.
+    rise_cycles.clear();
+    registers.ctrl = PpuCtrl(0b0001'1000);
+    step_execution(kCyclesPerScanline);
+    EXPECT_TRUE(rise_cycles.empty());
+
+    // Or when rendering is disabled.
+    registers.ctrl = PpuCtrl(0b0000'1000);
+    registers.mask = PpuMask(0x00);
+    step_execution(kCyclesPerScanline);
+    EXPECT_TRUE(rise_cycles.empty());
+}
+
 TEST_F(PpuTest, set_vblank_flag_during_vertical_blanking) {
     registers.status = PpuStatus(0x00);
     expected.status = PpuStatus(0x80);
@@ -516,6 +549,77 @@ TEST_F(PpuTest, skips_first_cycle_on_odd_frames_when_rendering_is_enabled) {
     EXPECT_EQ(expected, registers);
 }
 
+TEST_F(PpuTest, pal_has_a_longer_vblank_and_no_skipped_cycle) {
+    ppu = PpuFactory::create(&registers, &mmu, Timing::Pal);
+    registers.mask = PpuMask(0b000'1000); // Enable background rendering
+
+    step_execution(kCyclesPerScanline * 241 + 2);
+    EXPECT_EQ(0x80, registers.status.value());
+
+    // Still in vblank where NTSC's pre-render scanline is.
+    step_execution(kCyclesPerScanline * 20);
+    EXPECT_EQ(261, registers.scanline);
+    EXPECT_EQ(0x80, registers.status.value());
+
+    // The pre-render scanline is 311.
+    step_execution(kCyclesPerScanline * 50);
+    EXPECT_EQ(311, registers.scanline);
+    EXPECT_EQ(0x00, registers.status.value());
+
+    // The odd frame starts at cycle 0 even though rendering is enabled.
+    step_execution(kCyclesPerScanline - 2);
+    EXPECT_TRUE(registers.odd_frame);
+    EXPECT_EQ(0, registers.scanline);
+    EXPECT_EQ(0, registers.cycle);
+}
+
+TEST_F(PpuTest, dendy_starts_vblank_after_50_more_scanlines) {
+    ppu = PpuFactory::create(&registers, &mmu, Timing::Dendy);
+
+    step_execution(kCyclesPerScanline * 291 + 1);
+    EXPECT_EQ(0x00, registers.status.value());
+
+    step_execution(1);
+    EXPECT_EQ(0x80, registers.status.value());
+    EXPECT_EQ(291, registers.scanline);
+}
+
+TEST_F(PpuTest, trace_phases_stay_balanced_when_tracing_is_toggled) {
+    Trace::clear();
+
+    // Turn tracing off and on again in the middle of the same phase.
+    Trace::enable(true);
+    step_execution(10);
+    Trace::enable(false);
+    step_execution(10);
+    Trace::enable(true);
+    step_execution(10);
+    Trace::enable(false);
+    step_execution(1);
+
+    std::stringstream ss;
+    Trace::write_json(ss);
+    Trace::clear();
+    const std::string json = ss.str();
+
+    int depth = 0;
+    int begins = 0;
+    for (std::size_t pos = json.find("\"ph\":\"");
+            pos != std::string::npos;
+            pos = json.find("\"ph\":\"", pos + 1)) {
+        const char phase = json[pos + 6];
+        if (phase == 'B') {
+            ++depth;
+            ++begins;
+        } else if (phase == 'E') {
+            --depth;
+        }
+        ASSERT_GE(depth, 0);
+    }
+    EXPECT_EQ(0, depth);
+    EXPECT_EQ(2, begins);
+}
+
 TEST_F(PpuTest, render_one_pixel) {
     registers.cycle = 1;
     registers.mask = expected.mask = PpuMask(0x1E); // Enable all rendering.
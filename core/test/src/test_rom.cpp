@@ -2,17 +2,37 @@
 #include "nes/core/irom.h"
 #include "nes/core/rom_factory.h"
 
+#include <fmt/format.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <array>
 #include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
 #include <sstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#else
+#include <process.h>
+#endif
 
 using namespace n_e_s::core;
 
 namespace {
 
-enum class Mapper { Nrom = 0, Mapper2 = 2, Mapper3 = 3 };
+enum class Mapper {
+    Nrom = 0,
+    Mapper1 = 1,
+    Mapper2 = 2,
+    Mapper3 = 3,
+    Mapper4 = 4,
+};
 
 std::string ines_header_bytes(const uint8_t mapper_id,
         const uint8_t prg_rom_size,
@@ -25,7 +45,7 @@ std::string ines_header_bytes(const uint8_t mapper_id,
             static_cast<uint8_t>(mapper_id & static_cast<uint8_t>(0xF0u));
     header.prg_rom_size = prg_rom_size;
     header.chr_rom_size = chr_rom_size;
-    header.prg_ram_size = prg_ram_size;
+    header.flags_8 = prg_ram_size;
 
     std::string bytes;
     bytes.resize(sizeof(header));
@@ -58,6 +78,46 @@ void set_prg_rom_byte(const int prg_rom_banks,
     std::memcpy(&bytes->operator[](bytes_offset), &data, sizeof(data));
 }
 
+int process_id() {
+#if defined(__unix__) || defined(__APPLE__)
+    return ::getpid();
+#else
+    return ::_getpid();
+#endif
+}
+
+// Writes roms to files named after the test and the process, so that tests
+// running in parallel don't share them, and removes them and their save
+// files afterwards.
+class RomFileTest : public ::testing::Test {
+public:
+    void TearDown() override {
+        std::error_code ec;
+        std::filesystem::remove(rom_path_, ec);
+        std::filesystem::remove(save_path(), ec);
+    }
+
+    const std::filesystem::path &write_rom(const std::string &bytes) {
+        std::ofstream(rom_path_, std::ios::binary) << bytes;
+        return rom_path_;
+    }
+
+    std::filesystem::path save_path() const {
+        return std::filesystem::path(rom_path_).replace_extension(".sav");
+    }
+
+private:
+    static std::filesystem::path unique_rom_path() {
+        const std::string test_name{::testing::UnitTest::GetInstance()
+                        ->current_test_info()
+                        ->name()};
+        return std::filesystem::temp_directory_path() /
+               fmt::format("n_e_s_{}_{}.nes", test_name, process_id());
+    }
+
+    const std::filesystem::path rom_path_{unique_rom_path()};
+};
+
 TEST(RomFactory, doesnt_parse_streams_with_too_few_bytes) {
     std::string bytes(15, 0);
     std::stringstream ss(bytes);
@@ -79,6 +139,166 @@ TEST(RomFactory, fails_if_mapper_not_supported) {
                             testing::HasSubstr("Unsupported mapper: 205"))));
 }
 
+TEST(RomFactory, ignores_data_after_the_chr_rom) {
+    std::string bytes{nrom_bytes(1, 1, Mapper::Nrom)};
+    bytes.append(128, 0);
+    std::stringstream ss(bytes);
+    EXPECT_NO_THROW(auto tmp = RomFactory::from_bytes(ss));
+}
+
+TEST(RomFactory, skips_the_trainer) {
+    std::string bytes{nrom_bytes(1, 1, Mapper::Nrom)};
+    set_prg_rom_byte(1, &bytes, 0x0000, 0xAB);
+    bytes[6] |= 0x04; // Trainer
+    bytes.insert(sizeof(INesHeader), 512, 0);
+    std::stringstream ss(bytes);
+    std::unique_ptr<IRom> rom = RomFactory::from_bytes(ss);
+    EXPECT_EQ(0xAB, rom->cpu_read_byte(0x8000));
+}
+
+TEST(RomFactory, from_file_fails_if_file_is_missing) {
+    EXPECT_THROW(auto tmp = RomFactory::from_file(
+                         std::filesystem::temp_directory_path() /
+                         "n_e_s_missing.nes"),
+            std::runtime_error);
+}
+
+TEST_F(RomFileTest, from_file_reads_the_mapped_rom) {
+    std::string bytes{nrom_bytes(1, 1, Mapper::Nrom)};
+    set_prg_rom_byte(1, &bytes, 0x0000, 0xAB); // Mapped to 0x8000
+    bytes[sizeof(INesHeader) + 16 * 1024] = 0x12; // Chr rom 0x0000
+
+    const auto &path = write_rom(bytes);
+    std::unique_ptr<IRom> nrom = RomFactory::from_file(path);
+    std::unique_ptr<IRom> other = RomFactory::from_file(path);
+    std::filesystem::remove(path);
+
+    EXPECT_EQ(0xAB, nrom->cpu_read_byte(0x8000));
+    EXPECT_EQ(0x12, nrom->ppu_read_byte(0x0000));
+
+    // Writing to chr rom must not affect other roms sharing the image.
+    nrom->ppu_write_byte(0x0000, 0x34);
+    EXPECT_EQ(0x34, nrom->ppu_read_byte(0x0000));
+    EXPECT_EQ(0x12, other->ppu_read_byte(0x0000));
+}
+
+TEST_F(RomFileTest, battery_backed_prg_ram_is_kept_in_a_save_file) {
+    std::string bytes{nrom_bytes(1, 1, Mapper::Mapper1)};
+    bytes[6] |= 0x02; // Battery
+
+    const auto &path = write_rom(bytes);
+    std::unique_ptr<IRom> rom = RomFactory::from_file(path, save_path());
+    rom->cpu_write_byte(0x6000, 0xAB);
+    rom->cpu_write_byte(0x7FFF, 0xCD);
+    rom.reset();
+
+    ASSERT_EQ(8u * 1024u, std::filesystem::file_size(save_path()));
+    rom = RomFactory::from_file(path, save_path());
+    EXPECT_EQ(0xAB, rom->cpu_read_byte(0x6000));
+    EXPECT_EQ(0xCD, rom->cpu_read_byte(0x7FFF));
+}
+
+TEST_F(RomFileTest, battery_backed_prg_ram_isnt_saved_without_a_save_path) {
+    std::string bytes{nrom_bytes(1, 1, Mapper::Mapper1)};
+    bytes[6] |= 0x02; // Battery
+
+    const auto &path = write_rom(bytes);
+    std::unique_ptr<IRom> rom = RomFactory::from_file(path);
+    std::unique_ptr<IRom> other = RomFactory::from_file(path);
+    rom->cpu_write_byte(0x6000, 0xAB);
+    EXPECT_EQ(0xAB, rom->cpu_read_byte(0x6000));
+    EXPECT_EQ(0x00, other->cpu_read_byte(0x6000));
+    rom.reset();
+
+    EXPECT_FALSE(std::filesystem::exists(save_path()));
+}
+
+TEST_F(RomFileTest, save_files_in_use_fall_back_to_private_ram) {
+    std::string bytes{nrom_bytes(1, 1, Mapper::Mapper1)};
+    bytes[6] |= 0x02; // Battery
+
+    const auto &path = write_rom(bytes);
+    std::unique_ptr<IRom> rom = RomFactory::from_file(path, save_path());
+    std::unique_ptr<IRom> other = RomFactory::from_file(path, save_path());
+    rom->cpu_write_byte(0x6000, 0xAB);
+    other->cpu_write_byte(0x6000, 0xCD);
+    EXPECT_EQ(0xAB, rom->cpu_read_byte(0x6000));
+    EXPECT_EQ(0xCD, other->cpu_read_byte(0x6000));
+}
+
+TEST_F(RomFileTest, larger_save_files_arent_truncated) {
+    std::string bytes{nrom_bytes(1, 1, Mapper::Mapper1)};
+    bytes[6] |= 0x02; // Battery
+
+    std::string save(16 * 1024, '\0');
+    save[0] = 0x12;
+    save[8 * 1024] = 0x34;
+    std::ofstream(save_path(), std::ios::binary) << save;
+
+    const auto &path = write_rom(bytes);
+    std::unique_ptr<IRom> rom = RomFactory::from_file(path, save_path());
+    EXPECT_EQ(0x12, rom->cpu_read_byte(0x6000));
+    rom->cpu_write_byte(0x7FFF, 0xCD);
+    rom.reset();
+
+    ASSERT_EQ(16u * 1024u, std::filesystem::file_size(save_path()));
+    std::ifstream fs(save_path(), std::ios::binary);
+    save.assign(std::istreambuf_iterator<char>(fs),
+            std::istreambuf_iterator<char>());
+    EXPECT_EQ(0xCD, static_cast<uint8_t>(save[8 * 1024 - 1]));
+    EXPECT_EQ(0x34, save[8 * 1024]);
+}
+
+TEST_F(RomFileTest, smaller_save_files_are_left_alone) {
+    std::string bytes{nrom_bytes(1, 1, Mapper::Mapper1)};
+    bytes[6] |= 0x02; // Battery
+
+    std::ofstream(save_path(), std::ios::binary) << std::string(1024, 'x');
+
+    std::unique_ptr<IRom> rom =
+            RomFactory::from_file(write_rom(bytes), save_path());
+    rom->cpu_write_byte(0x6000, 0xAB);
+    EXPECT_EQ(0xAB, rom->cpu_read_byte(0x6000));
+    rom.reset();
+
+    ASSERT_EQ(1024u, std::filesystem::file_size(save_path()));
+    std::ifstream fs(save_path(), std::ios::binary);
+    EXPECT_EQ('x', fs.get());
+}
+
+TEST_F(RomFileTest, prg_ram_without_battery_isnt_saved) {
+    std::string bytes{nrom_bytes(1, 1, Mapper::Mapper1)};
+
+    std::unique_ptr<IRom> rom =
+            RomFactory::from_file(write_rom(bytes), save_path());
+    rom->cpu_write_byte(0x6000, 0xAB);
+    rom.reset();
+
+    EXPECT_FALSE(std::filesystem::exists(save_path()));
+}
+
+TEST(RomFactory, identical_roms_share_their_image) {
+    const std::size_t cached = RomFactory::cached_image_count();
+    std::string bytes{nrom_bytes(1, 1, Mapper::Nrom)};
+    std::stringstream ss(bytes);
+    std::unique_ptr<IRom> nrom = RomFactory::from_bytes(ss);
+    ss = std::stringstream(bytes);
+    std::unique_ptr<IRom> same = RomFactory::from_bytes(ss);
+    EXPECT_EQ(cached + 1, RomFactory::cached_image_count());
+
+    set_prg_rom_byte(1, &bytes, 0x0000, 0xAB);
+    ss = std::stringstream(bytes);
+    std::unique_ptr<IRom> different = RomFactory::from_bytes(ss);
+    EXPECT_EQ(cached + 2, RomFactory::cached_image_count());
+    EXPECT_EQ(0x00, same->cpu_read_byte(0x8000));
+    EXPECT_EQ(0xAB, different->cpu_read_byte(0x8000));
+
+    nrom.reset();
+    same.reset();
+    different.reset();
+    EXPECT_EQ(cached, RomFactory::cached_image_count());
+}
+
 TEST(Nrom, creation_works_with_correct_rom_sizes) {
     std::string bytes{nrom_bytes(1, 1, Mapper::Nrom)};
     std::stringstream ss(bytes);
@@ -231,6 +451,319 @@ TEST(Nrom, write_and_read_byte_cpu_bus_32k_prg_rom) {
     EXPECT_EQ(0x78, nrom->cpu_read_byte(0xFFFF));
 }
 
+TEST(Nrom, cpu_read_block_from_prg_ram_into_mirrored_prg_rom) {
+    std::string bytes{nrom_bytes(1, 1, Mapper::Nrom)};
+    set_prg_rom_byte(1, &bytes, 0x0000, 0xAB); // Mapped to 0x8000
+    set_prg_rom_byte(1, &bytes, 0x3FFF, 0x10); // Mapped to 0xBFFF
+    std::stringstream ss(bytes);
+    std::unique_ptr<IRom> nrom = RomFactory::from_bytes(ss);
+    nrom->cpu_write_byte(0x7FFF, 0x0F);
+
+    std::array<uint8_t, 2> result{};
+    nrom->cpu_read_block(0x7FFF, result);
+    EXPECT_EQ((std::array<uint8_t, 2>{0x0F, 0xAB}), result);
+
+    nrom->cpu_read_block(0xBFFF, result);
+    EXPECT_EQ((std::array<uint8_t, 2>{0x10, 0xAB}), result);
+}
+
+TEST(Nrom, ppu_read_block_from_chr_into_nametables) {
+    std::string bytes{nrom_bytes(1, 1, Mapper::Nrom)};
+    std::stringstream ss(bytes);
+    std::unique_ptr<IRom> nrom = RomFactory::from_bytes(ss);
+    nrom->ppu_write_byte(0x1FFF, 0x89);
+    nrom->ppu_write_byte(0x2000, 0x12);
+
+    std::array<uint8_t, 2> result{};
+    nrom->ppu_read_block(0x1FFF, result);
+    EXPECT_EQ((std::array<uint8_t, 2>{0x89, 0x12}), result);
+}
+
+////////////////////////////////////////////////////////////////
+// Mapper 1 tests
+void write_mmc1_register(IRom *rom, uint16_t addr, uint8_t value) {
+    for (int i = 0; i < 5; ++i) {
+        rom->cpu_write_byte(addr, static_cast<uint8_t>(value >> i) & 1u);
+    }
+}
+
+TEST(Mapper1, is_cpu_address_in_range) {
+    std::string bytes{nrom_bytes(2, 1, Mapper::Mapper1)};
+    std::stringstream ss(bytes);
+    std::unique_ptr<IRom> rom = RomFactory::from_bytes(ss);
+
+    EXPECT_FALSE(rom->is_cpu_address_in_range(0x5FFF));
+    EXPECT_TRUE(rom->is_cpu_address_in_range(0x6000));
+    EXPECT_TRUE(rom->is_cpu_address_in_range(0xFFFF));
+}
+
+TEST(Mapper1, switches_prg_banks) {
+    constexpr int kPrgRomBanks = 4;
+    std::string bytes{nrom_bytes(kPrgRomBanks, 1, Mapper::Mapper1)};
+    for (uint8_t bank = 0; bank < kPrgRomBanks; ++bank) {
+        set_prg_rom_byte(kPrgRomBanks, &bytes, bank * 0x4000u, bank + 1u);
+    }
+    std::stringstream ss(bytes);
+    std::unique_ptr<IRom> rom = RomFactory::from_bytes(ss);
+
+    // Powers on with the last bank fixed at $C000.
+    EXPECT_EQ(0x01, rom->cpu_read_byte(0x8000));
+    EXPECT_EQ(0x04, rom->cpu_read_byte(0xC000));
+
+    write_mmc1_register(rom.get(), 0xE000, 0x02);
+    EXPECT_EQ(0x03, rom->cpu_read_byte(0x8000));
+    EXPECT_EQ(0x04, rom->cpu_read_byte(0xC000));
+
+    // Prg mode 2, first bank fixed at $8000.
+    write_mmc1_register(rom.get(), 0x8000, 0x08);
+    EXPECT_EQ(0x01, rom->cpu_read_byte(0x8000));
+    EXPECT_EQ(0x03, rom->cpu_read_byte(0xC000));
+
+    // Prg mode 0, 32 KB switched ignoring the low bit of the bank.
+    write_mmc1_register(rom.get(), 0x8000, 0x00);
+    write_mmc1_register(rom.get(), 0xE000, 0x03);
+    EXPECT_EQ(0x03, rom->cpu_read_byte(0x8000));
+    EXPECT_EQ(0x04, rom->cpu_read_byte(0xC000));
+
+    // Writing bit 7 resets to prg mode 3, switching bank 3 in at $8000.
+    rom->cpu_write_byte(0x8000, 0x80);
+    EXPECT_EQ(0x04, rom->cpu_read_byte(0x8000));
+    EXPECT_EQ(0x04, rom->cpu_read_byte(0xC000));
+}
+
+TEST(Mapper1, chr_bank_selects_the_prg_half_on_512_kb_boards) {
+    constexpr int kPrgRomBanks = 32;
+    std::string bytes{nrom_bytes(kPrgRomBanks, 1, Mapper::Mapper1)};
+    for (uint8_t bank = 0; bank < kPrgRomBanks; ++bank) {
+        set_prg_rom_byte(kPrgRomBanks, &bytes, bank * 0x4000u, bank + 1u);
+    }
+    std::stringstream ss(bytes);
+    std::unique_ptr<IRom> rom = RomFactory::from_bytes(ss);
+
+    // The last bank of the first half is fixed at $C000.
+    EXPECT_EQ(0x01, rom->cpu_read_byte(0x8000));
+    EXPECT_EQ(0x10, rom->cpu_read_byte(0xC000));
+
+    write_mmc1_register(rom.get(), 0xA000, 0x10);
+    EXPECT_EQ(0x11, rom->cpu_read_byte(0x8000));
+    EXPECT_EQ(0x20, rom->cpu_read_byte(0xC000));
+
+    write_mmc1_register(rom.get(), 0xE000, 0x02);
+    EXPECT_EQ(0x13, rom->cpu_read_byte(0x8000));
+
+    write_mmc1_register(rom.get(), 0xA000, 0x00);
+    EXPECT_EQ(0x03, rom->cpu_read_byte(0x8000));
+    EXPECT_EQ(0x10, rom->cpu_read_byte(0xC000));
+}
+
+TEST(Mapper1, reset_discards_partial_writes) {
+    constexpr int kPrgRomBanks = 4;
+    std::string bytes{nrom_bytes(kPrgRomBanks, 1, Mapper::Mapper1)};
+    set_prg_rom_byte(kPrgRomBanks, &bytes, 1u * 0x4000u, 0x02);
+    std::stringstream ss(bytes);
+    std::unique_ptr<IRom> rom = RomFactory::from_bytes(ss);
+
+    rom->cpu_write_byte(0xE000, 0x01);
+    rom->cpu_write_byte(0xE000, 0x01);
+    rom->cpu_write_byte(0xE000, 0x80);
+    write_mmc1_register(rom.get(), 0xE000, 0x01);
+
+    EXPECT_EQ(0x02, rom->cpu_read_byte(0x8000));
+}
+
+TEST(Mapper1, switches_chr_banks) {
+    constexpr int kChrRomBanks = 4;
+    std::string bytes{nrom_bytes(1, kChrRomBanks, Mapper::Mapper1)};
+    for (uint8_t bank = 0; bank < kChrRomBanks * 2; ++bank) {
+        bytes[sizeof(INesHeader) + 0x4000u + bank * 0x1000u] =
+                static_cast<char>(bank + 1);
+    }
+    std::stringstream ss(bytes);
+    std::unique_ptr<IRom> rom = RomFactory::from_bytes(ss);
+
+    // 8 KB mode ignores the low bit of the bank.
+    write_mmc1_register(rom.get(), 0xA000, 0x03);
+    EXPECT_EQ(0x03, rom->ppu_read_byte(0x0000));
+    EXPECT_EQ(0x04, rom->ppu_read_byte(0x1000));
+
+    // 4 KB mode.
+    write_mmc1_register(rom.get(), 0x8000, 0x10);
+    write_mmc1_register(rom.get(), 0xC000, 0x06);
+    EXPECT_EQ(0x04, rom->ppu_read_byte(0x0000));
+    EXPECT_EQ(0x07, rom->ppu_read_byte(0x1000));
+}
+
+TEST(Mapper1, switches_mirroring) {
+    std::string bytes{nrom_bytes(1, 1, Mapper::Mapper1)};
+    std::stringstream ss(bytes);
+    std::unique_ptr<IRom> rom = RomFactory::from_bytes(ss);
+
+    // Vertical
+    write_mmc1_register(rom.get(), 0x8000, 0x02);
+    rom->ppu_write_byte(0x2000, 0x01);
+    rom->ppu_write_byte(0x2400, 0x02);
+    EXPECT_EQ(0x01, rom->ppu_read_byte(0x2800));
+    EXPECT_EQ(0x02, rom->ppu_read_byte(0x2C00));
+
+    // Horizontal
+    write_mmc1_register(rom.get(), 0x8000, 0x03);
+    EXPECT_EQ(0x01, rom->ppu_read_byte(0x2400));
+    EXPECT_EQ(0x02, rom->ppu_read_byte(0x2800));
+
+    // Single screen upper
+    write_mmc1_register(rom.get(), 0x8000, 0x01);
+    EXPECT_EQ(0x02, rom->ppu_read_byte(0x2000));
+    EXPECT_EQ(0x02, rom->ppu_read_byte(0x2C00));
+}
+
+TEST(Mapper1, write_and_read_prg_ram) {
+    std::string bytes{nrom_bytes(2, 1, Mapper::Mapper1)};
+    std::stringstream ss(bytes);
+    std::unique_ptr<IRom> rom = RomFactory::from_bytes(ss);
+
+    rom->cpu_write_byte(0x6000, 0x0F);
+    rom->cpu_write_byte(0x7FFF, 0xF0);
+    EXPECT_EQ(0x0F, rom->cpu_read_byte(0x6000));
+    EXPECT_EQ(0xF0, rom->cpu_read_byte(0x7FFF));
+}
+
+TEST(Mapper1, uses_nes2_chr_ram_size) {
+    std::string bytes{nrom_bytes(1, 0, Mapper::Mapper1)};
+    bytes[7] |= 0x08; // NES 2.0
+    bytes[11] = 0x09; // 32 KB chr ram
+    std::stringstream ss(bytes);
+    std::unique_ptr<IRom> rom = RomFactory::from_bytes(ss);
+
+    // With 8 KB of chr ram, 4 KB bank 2 would mirror bank 0.
+    rom->ppu_write_byte(0x0000, 0xAB);
+    write_mmc1_register(rom.get(), 0x8000, 0x10);
+    write_mmc1_register(rom.get(), 0xA000, 0x02);
+    EXPECT_EQ(0x00, rom->ppu_read_byte(0x0000));
+    write_mmc1_register(rom.get(), 0xA000, 0x00);
+    EXPECT_EQ(0xAB, rom->ppu_read_byte(0x0000));
+}
+
+////////////////////////////////////////////////////////////////
+// Mapper 4 tests
+TEST(Mapper4, is_cpu_address_in_range) {
+    std::string bytes{nrom_bytes(2, 1, Mapper::Mapper4)};
+    std::stringstream ss(bytes);
+    std::unique_ptr<IRom> rom = RomFactory::from_bytes(ss);
+
+    EXPECT_FALSE(rom->is_cpu_address_in_range(0x5FFF));
+    EXPECT_TRUE(rom->is_cpu_address_in_range(0x6000));
+    EXPECT_TRUE(rom->is_cpu_address_in_range(0xFFFF));
+}
+
+TEST(Mapper4, switches_prg_banks) {
+    constexpr int kPrgRomBanks = 2;
+    std::string bytes{nrom_bytes(kPrgRomBanks, 1, Mapper::Mapper4)};
+    for (uint8_t bank = 0; bank < kPrgRomBanks * 2; ++bank) {
+        set_prg_rom_byte(kPrgRomBanks, &bytes, bank * 0x2000u, bank + 1u);
+    }
+    std::stringstream ss(bytes);
+    std::unique_ptr<IRom> rom = RomFactory::from_bytes(ss);
+
+    rom->cpu_write_byte(0x8000, 0x06);
+    rom->cpu_write_byte(0x8001, 0x01);
+    rom->cpu_write_byte(0x8000, 0x07);
+    rom->cpu_write_byte(0x8001, 0x00);
+    EXPECT_EQ(0x02, rom->cpu_read_byte(0x8000));
+    EXPECT_EQ(0x01, rom->cpu_read_byte(0xA000));
+    EXPECT_EQ(0x03, rom->cpu_read_byte(0xC000));
+    EXPECT_EQ(0x04, rom->cpu_read_byte(0xE000));
+
+    // Prg mode 1 fixes the second last bank at $8000 instead of $C000.
+    rom->cpu_write_byte(0x8000, 0x40);
+    EXPECT_EQ(0x03, rom->cpu_read_byte(0x8000));
+    EXPECT_EQ(0x01, rom->cpu_read_byte(0xA000));
+    EXPECT_EQ(0x02, rom->cpu_read_byte(0xC000));
+    EXPECT_EQ(0x04, rom->cpu_read_byte(0xE000));
+}
+
+TEST(Mapper4, switches_chr_banks) {
+    constexpr int kChrRomBanks = 2;
+    std::string bytes{nrom_bytes(1, kChrRomBanks, Mapper::Mapper4)};
+    for (uint8_t bank = 0; bank < kChrRomBanks * 8; ++bank) {
+        bytes[sizeof(INesHeader) + 0x4000u + bank * 0x0400u] =
+                static_cast<char>(bank + 1);
+    }
+    std::stringstream ss(bytes);
+    std::unique_ptr<IRom> rom = RomFactory::from_bytes(ss);
+
+    // R0 switches 2 KB ignoring the low bit, R2 switches 1 KB.
+    rom->cpu_write_byte(0x8000, 0x00);
+    rom->cpu_write_byte(0x8001, 0x05);
+    rom->cpu_write_byte(0x8000, 0x02);
+    rom->cpu_write_byte(0x8001, 0x0B);
+    EXPECT_EQ(0x05, rom->ppu_read_byte(0x0000));
+    EXPECT_EQ(0x06, rom->ppu_read_byte(0x0400));
+    EXPECT_EQ(0x0C, rom->ppu_read_byte(0x1000));
+
+    // Chr mode 1 swaps the pattern tables.
+    rom->cpu_write_byte(0x8000, 0x80);
+    EXPECT_EQ(0x0C, rom->ppu_read_byte(0x0000));
+    EXPECT_EQ(0x05, rom->ppu_read_byte(0x1000));
+    EXPECT_EQ(0x06, rom->ppu_read_byte(0x1400));
+}
+
+TEST(Mapper4, switches_mirroring) {
+    std::string bytes{nrom_bytes(1, 1, Mapper::Mapper4)};
+    std::stringstream ss(bytes);
+    std::unique_ptr<IRom> rom = RomFactory::from_bytes(ss);
+
+    // Vertical
+    rom->cpu_write_byte(0xA000, 0x00);
+    rom->ppu_write_byte(0x2000, 0x01);
+    rom->ppu_write_byte(0x2400, 0x02);
+    EXPECT_EQ(0x01, rom->ppu_read_byte(0x2800));
+    EXPECT_EQ(0x02, rom->ppu_read_byte(0x2C00));
+
+    // Horizontal
+    rom->cpu_write_byte(0xA000, 0x01);
+    EXPECT_EQ(0x01, rom->ppu_read_byte(0x2400));
+    EXPECT_EQ(0x02, rom->ppu_read_byte(0x2800));
+}
+
+TEST(Mapper4, irq_counter_asserts_irq_when_reaching_zero) {
+    std::string bytes{nrom_bytes(1, 1, Mapper::Mapper4)};
+    std::stringstream ss(bytes);
+    std::unique_ptr<IRom> rom = RomFactory::from_bytes(ss);
+
+    std::vector<bool> irqs;
+    rom->set_irq_handler([&](bool asserted) { irqs.push_back(asserted); });
+
+    rom->cpu_write_byte(0xC000, 0x02); // Latch
+    rom->cpu_write_byte(0xC001, 0x00); // Reload
+    rom->cpu_write_byte(0xE001, 0x00); // Enable
+
+    // The first rise reloads the counter, the following two count it down.
+    rom->ppu_a12_rise();
+    rom->ppu_a12_rise();
+    EXPECT_TRUE(irqs.empty());
+    rom->ppu_a12_rise();
+    EXPECT_EQ(std::vector<bool>{true}, irqs);
+
+    // Acknowledging releases the irq and disables new ones.
+    rom->cpu_write_byte(0xE000, 0x00);
+    EXPECT_EQ((std::vector<bool>{true, false}), irqs);
+    for (int i = 0; i < 6; ++i) {
+        rom->ppu_a12_rise();
+    }
+    EXPECT_EQ((std::vector<bool>{true, false}), irqs);
+}
+
+TEST(Mapper4, write_and_read_prg_ram) {
+    std::string bytes{nrom_bytes(2, 1, Mapper::Mapper4)};
+    std::stringstream ss(bytes);
+    std::unique_ptr<IRom> rom = RomFactory::from_bytes(ss);
+
+    rom->cpu_write_byte(0x6000, 0x0F);
+    rom->cpu_write_byte(0x7FFF, 0xF0);
+    EXPECT_EQ(0x0F, rom->cpu_read_byte(0x6000));
+    EXPECT_EQ(0xF0, rom->cpu_read_byte(0x7FFF));
+}
+
 ////////////////////////////////////////////////////////////////
 // Mapper 2 tests
 TEST(Mapper2, is_cpu_address_in_range) {
@@ -327,6 +860,26 @@ TEST(Mapper2, write_and_read_byte_cpu_bus) {
     EXPECT_EQ(0xAB, rom->cpu_read_byte(0xC001));
 }
 
+TEST(Mapper2, cpu_read_block_follows_bank_switches) {
+    constexpr int kPrgRomBanks = 4;
+    std::string bytes{nrom_bytes(kPrgRomBanks, 1, Mapper::Mapper2)};
+    // Last byte of the second bank and first byte of the last bank.
+    set_prg_rom_byte(kPrgRomBanks, &bytes, 2u * 0x4000u - 1u, 0x02);
+    set_prg_rom_byte(kPrgRomBanks, &bytes, 3u * 0x4000u, 0x03);
+
+    std::stringstream ss(bytes);
+    std::unique_ptr<IRom> rom = RomFactory::from_bytes(ss);
+    rom->cpu_write_byte(0x8000, 0x01);
+
+    std::array<uint8_t, 2> result{};
+    rom->cpu_read_block(0xBFFF, result);
+    EXPECT_EQ((std::array<uint8_t, 2>{0x02, 0x03}), result);
+
+    // Selecting a bank past the end of the rom wraps around.
+    rom->cpu_write_byte(0x8000, 0x05);
+    EXPECT_EQ(0x02, rom->cpu_read_byte(0xBFFF));
+}
+
 ////////////////////////////////////////////////////////////////
 // Mapper 3 tests
 TEST(Mapper3, is_cpu_address_in_range) {
@@ -420,4 +973,36 @@ TEST(Mapper3, write_and_read_ppu_nametables) {
     EXPECT_EQ(0x04, rom->ppu_read_byte(0x2C00));
 }
 
+TEST(Nrom, vertical_mirroring) {
+    std::string bytes{nrom_bytes(1, 1, Mapper::Nrom)};
+    bytes[6] |= 0x01; // flags_6
+    std::stringstream ss(bytes);
+    std::unique_ptr<IRom> rom = RomFactory::from_bytes(ss);
+
+    rom->ppu_write_byte(0x2000, 0x01);
+    rom->ppu_write_byte(0x2400, 0x02);
+
+    EXPECT_EQ(0x01, rom->ppu_read_byte(0x2800));
+    EXPECT_EQ(0x02, rom->ppu_read_byte(0x2C00));
+    EXPECT_EQ(0x02, rom->ppu_read_byte(0x3400));
+}
+
+TEST(Nrom, four_screen_mirroring) {
+    std::string bytes{nrom_bytes(1, 1, Mapper::Nrom)};
+    bytes[6] |= 0x08; // flags_6
+    std::stringstream ss(bytes);
+    std::unique_ptr<IRom> rom = RomFactory::from_bytes(ss);
+
+    rom->ppu_write_byte(0x2000, 0x01);
+    rom->ppu_write_byte(0x2400, 0x02);
+    rom->ppu_write_byte(0x2800, 0x03);
+    rom->ppu_write_byte(0x2C00, 0x04);
+
+    EXPECT_EQ(0x01, rom->ppu_read_byte(0x2000));
+    EXPECT_EQ(0x02, rom->ppu_read_byte(0x2400));
+    EXPECT_EQ(0x03, rom->ppu_read_byte(0x2800));
+    EXPECT_EQ(0x04, rom->ppu_read_byte(0x2C00));
+    EXPECT_EQ(0x01, rom->ppu_read_byte(0x3000));
+}
+
 } // namespace
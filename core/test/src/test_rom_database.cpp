@@ -0,0 +1,96 @@
+#include "nes/core/rom_database.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+using namespace n_e_s::core;
+
+namespace {
+
+constexpr uint32_t crc32_of(std::string_view str) {
+    std::array<uint8_t, 9> bytes{};
+    for (std::size_t i = 0; i < str.size(); ++i) {
+        bytes[i] = static_cast<uint8_t>(str[i]);
+    }
+    return crc32(std::span(bytes).first(str.size()));
+}
+
+static_assert(crc32_of("") == 0x0000'0000u);
+static_assert(crc32_of("123456789") == 0xCBF4'3926u);
+
+constexpr RomDatabase kDatabase{std::to_array<RomDatabaseEntry>({
+        {0x1111'1111u, 4, 0, Mirroring::Vertical, 0, 8192, 0, Timing::Ntsc},
+        {0x2222'2221u, 1, 0, Mirroring::Horizontal, 8192, 0, 0, Timing::Pal},
+        // Collides with the entry above in the low bits.
+        {0x3333'3221u, 2, 0, Mirroring::Horizontal, 0, 0, 8192, Timing::Ntsc},
+})};
+
+TEST(RomDatabase, finds_entries_by_crc) {
+    static_assert(kDatabase.find(0x1111'1111u)->mapper == 4);
+    EXPECT_EQ(1, kDatabase.find(0x2222'2221u)->mapper);
+    EXPECT_EQ(2, kDatabase.find(0x3333'3221u)->mapper);
+    EXPECT_EQ(nullptr, kDatabase.find(0x4444'4444u));
+}
+
+TEST(RomDatabase, empty_database_finds_nothing) {
+    constexpr RomDatabase kEmpty{std::array<RomDatabaseEntry, 0>{}};
+    EXPECT_EQ(nullptr, kEmpty.find(0x1111'1111u));
+}
+
+TEST(RomDatabase, entries_rewrite_headers_as_nes2) {
+    INesHeader h;
+    h.prg_rom_size = 8;
+    h.chr_rom_size = 0;
+    h.flags_6 = 0x04; // Trainer
+    h.flags_7 = 0x00;
+    h.flags_8 = 0;
+    h.flags_9 = 0x01;
+
+    constexpr RomDatabaseEntry kEntry{
+            0x1234'5678u, 0x104, 3, Mirroring::Vertical, 0, 8192, 32768,
+            Timing::Dendy};
+    kEntry.apply_to(h);
+
+    EXPECT_TRUE(h.is_nes2());
+    EXPECT_EQ(0x104, h.mapper());
+    EXPECT_EQ(3, h.submapper());
+    EXPECT_EQ(Mirroring::Vertical, h.mirroring());
+    EXPECT_TRUE(h.has_battery());
+    EXPECT_TRUE(h.has_trainer());
+    EXPECT_EQ(0u, h.prg_ram_bytes());
+    EXPECT_EQ(8192u, h.prg_nvram_bytes());
+    EXPECT_EQ(32768u, h.chr_ram_bytes());
+    EXPECT_EQ(Timing::Dendy, h.timing());
+    EXPECT_EQ(8u * 16u * 1024u, h.prg_rom_bytes());
+}
+
+TEST(RomDatabase, entries_clear_garbage_in_old_headers) {
+    INesHeader h;
+    h.prg_rom_size = 2;
+    h.chr_rom_size = 1;
+    h.flags_6 = 0x00;
+    h.flags_7 = 0x44; // 'D', from "DiskDude!".
+    h.flags_8 = 'i';
+    h.flags_9 = 's';
+    h.flags_10 = 'k';
+    h.flags_11 = 'D';
+    h.flags_12 = 'u';
+    h.flags_13 = 'd';
+    h.flags_14 = 'e';
+    h.flags_15 = '!';
+
+    constexpr RomDatabaseEntry kEntry{
+            0x1234'5678u, 1, 0, Mirroring::Horizontal, 8192, 0, 0,
+            Timing::Ntsc};
+    kEntry.apply_to(h);
+
+    EXPECT_TRUE(h.is_nes2());
+    EXPECT_EQ(0, h.flags_13);
+    EXPECT_EQ(0, h.flags_14);
+    EXPECT_EQ(0, h.flags_15);
+}
+
+} // namespace
@@ -0,0 +1,101 @@
+#include "nes/core/trace.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace n_e_s::core;
+
+namespace {
+
+class TraceTest : public ::testing::Test {
+public:
+    TraceTest() {
+        Trace::clear();
+    }
+
+    ~TraceTest() override {
+        Trace::enable(false);
+        Trace::clear();
+    }
+
+    static std::string json() {
+        std::stringstream ss;
+        Trace::write_json(ss);
+        return ss.str();
+    }
+};
+
+TEST_F(TraceTest, nothing_recorded_when_disabled) {
+    {
+        const TraceScope scope("scope");
+    }
+
+    EXPECT_EQ("{\"traceEvents\":[\n]}\n", json());
+}
+
+TEST_F(TraceTest, scope_records_begin_and_end) {
+    Trace::enable(true);
+    {
+        const TraceScope scope("scope");
+    }
+    Trace::enable(false);
+
+    const std::string result = json();
+    EXPECT_NE(std::string::npos,
+            result.find(R"("name":"scope","ph":"B")"));
+    EXPECT_NE(std::string::npos,
+            result.find(R"("name":"scope","ph":"E")"));
+}
+
+TEST_F(TraceTest, scope_ends_even_if_disabled_while_open) {
+    Trace::enable(true);
+    {
+        const TraceScope scope("scope");
+        Trace::enable(false);
+    }
+
+    EXPECT_NE(std::string::npos, json().find(R"("ph":"E")"));
+}
+
+TEST_F(TraceTest, instant_events_are_thread_scoped) {
+    Trace::instant("nmi");
+
+    EXPECT_NE(std::string::npos, json().find(R"("ph":"i")"));
+    EXPECT_NE(std::string::npos, json().find(R"("s":"t")"));
+}
+
+TEST_F(TraceTest, records_more_events_than_fit_in_one_chunk) {
+    for (int i = 0; i < 10000; ++i) {
+        Trace::instant("event");
+    }
+
+    const std::string result = json();
+    std::size_t count = 0;
+    for (std::size_t pos = result.find("\"event\""); pos != std::string::npos;
+            pos = result.find("\"event\"", pos + 1)) {
+        ++count;
+    }
+    EXPECT_EQ(10000u, count);
+}
+
+TEST_F(TraceTest, threads_record_into_separate_buffers) {
+    Trace::instant("main");
+    std::thread([] { Trace::instant("worker"); }).join();
+
+    const std::string result = json();
+    const std::size_t main = result.find("\"main\"");
+    const std::size_t worker = result.find("\"worker\"");
+    ASSERT_NE(std::string::npos, main);
+    ASSERT_NE(std::string::npos, worker);
+
+    const auto tid_of = [&](std::size_t pos) {
+        const std::size_t tid = result.find("\"tid\":", pos);
+        return result.substr(tid, result.find_first_of(",}", tid) - tid);
+    };
+    EXPECT_NE(tid_of(main), tid_of(worker));
+}
+
+} // namespace
@@ -13,6 +13,7 @@ class FakePpu : public IPpu {
         return {};
     }
     void set_nmi_handler(const std::function<void()> &) override {}
+    void set_a12_rise_handler(const std::function<void()> &) override {}
 
     uint16_t scanline() const override {
         return 0u;
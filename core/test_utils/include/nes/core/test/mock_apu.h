@@ -0,0 +1,53 @@
+#pragma once
+
+#include "nes/core/iapu.h"
+
+#include <gmock/gmock.h>
+
+namespace n_e_s::core::test {
+
+class MockApu : public IApu {
+public:
+    MOCK_METHOD(uint8_t, read_byte, (uint16_t addr), (override));
+    MOCK_METHOD(void, write_byte, (uint16_t addr, uint8_t byte), (override));
+    MOCK_METHOD(uint8_t, peek_byte, (uint16_t addr), (const, override));
+
+    MOCK_METHOD(void, run_until, (uint64_t cpu_cycle), (override));
+    MOCK_METHOD(void,
+            set_cpu_clock,
+            (const std::function<uint64_t()> &cpu_clock),
+            (override));
+
+    MOCK_METHOD(void, set_sample_rate, (uint32_t sample_rate), (override));
+    MOCK_METHOD(void,
+            set_resampling_quality,
+            (ResamplingQuality quality),
+            (override));
+
+    MOCK_METHOD(void,
+            set_irq_handler,
+            ((const std::function<void(uint8_t, bool)> &irq_handler)),
+            (override));
+    MOCK_METHOD(void,
+            set_irq_scheduler,
+            ((const std::function<void(uint8_t, uint64_t)> &irq_scheduler)),
+            (override));
+    MOCK_METHOD(void,
+            set_dma_reader,
+            ((const std::function<uint8_t(uint16_t)> &dma_reader)),
+            (override));
+    MOCK_METHOD(void,
+            set_dma_scheduler,
+            ((const std::function<void(std::optional<uint64_t>)>
+                            &dma_scheduler)),
+            (override));
+    MOCK_METHOD(void, dma, (uint64_t cpu_cycle), (override));
+
+    MOCK_METHOD(void, set_sample_sink, (const SampleSink &sink), (override));
+    MOCK_METHOD(void,
+            set_channel_sample_sink,
+            (Channel channel, const SampleSink &sink),
+            (override));
+};
+
+} // namespace n_e_s::core::test
@@ -17,6 +17,10 @@ public:
             set_nmi_handler,
             (const std::function<void()> &nmi_handler),
             (override));
+    MOCK_METHOD(void,
+            set_a12_rise_handler,
+            (const std::function<void()> &a12_rise_handler),
+            (override));
 
     MOCK_METHOD(uint16_t, scanline, (), (const, override));
     MOCK_METHOD(uint16_t, cycle, (), (const, override));
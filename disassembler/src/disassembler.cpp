@@ -5,7 +5,6 @@
 #include "nes/core/opcode.h"
 
 #include <fmt/format.h>
-#include <set>
 #include <string>
 
 namespace n_e_s::dis {
@@ -31,14 +30,9 @@ constexpr int8_t to_signed(uint8_t byte) {
     return static_cast<int8_t>(low_bits(byte));
 }
 
+// Peek so that disassembling never changes the state of the emulation.
 std::uint8_t read_mmu(const n_e_s::core::IMmu &mmu, const uint16_t addr) {
-    // Do not read from any ppu registers since they could have side effects.
-    if (std::set<std::uint16_t>{
-                0x2000, 0x2001, 0x2002, 0x2003, 0x2004, 0x2005, 0x2006, 0x2007}
-                    .contains(addr)) {
-        return 0;
-    }
-    return mmu.read_byte(addr);
+    return mmu.peek_byte(addr);
 }
 
 } // namespace
@@ -46,7 +40,7 @@ std::uint8_t read_mmu(const n_e_s::core::IMmu &mmu, const uint16_t addr) {
 std::string disassemble(const uint16_t address,
         const n_e_s::core::IMmu &mmu,
         const n_e_s::core::CpuRegisters &reg) {
-    const auto opcode = n_e_s::core::decode(mmu.read_byte(address));
+    const auto opcode = n_e_s::core::decode(read_mmu(mmu, address));
 
     const auto family = n_e_s::core::to_string(opcode.family);
     const std::string mem_string =
@@ -10,9 +10,30 @@ using namespace n_e_s::dis;
 
 namespace {
 
+// Reading ppu registers has side effects, so they may only be peeked.
+class PpuRegisterMmu : public n_e_s::core::test::FakeMmu {
+public:
+    uint8_t read_byte(uint16_t addr) const override {
+        if (is_ppu_register(addr)) {
+            ADD_FAILURE() << "Read ppu register " << addr;
+            return 0;
+        }
+        return FakeMmu::read_byte(addr);
+    }
+
+    uint8_t peek_byte(uint16_t addr) const override {
+        return is_ppu_register(addr) ? 0 : FakeMmu::read_byte(addr);
+    }
+
+private:
+    static bool is_ppu_register(uint16_t addr) {
+        return addr >= 0x2000 && addr <= 0x2007;
+    }
+};
+
 class DisassemblerFixture : public testing::Test {
 public:
-    n_e_s::core::test::FakeMmu mmu;
+    PpuRegisterMmu mmu;
     n_e_s::core::CpuRegisters reg;
 
     void load_hex_dump(uint16_t address, const std::vector<uint8_t> &data) {
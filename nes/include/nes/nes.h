@@ -1,5 +1,7 @@
 #pragma once
 
+#include <filesystem>
+#include <iosfwd>
 #include <memory>
 #include <optional>
 #include <string>
@@ -7,6 +9,7 @@
 #include "nes/core/pixel.h"
 
 namespace n_e_s::core {
+class CpuProfiler;
 class IMos6502;
 struct CpuRegisters;
 
@@ -21,6 +24,8 @@ class IRom;
 
 class INesController;
 
+enum class Timing;
+
 } // namespace n_e_s::core
 
 namespace n_e_s::nes {
@@ -30,10 +35,17 @@ public:
     Nes();
     ~Nes();
 
-    // Run at 263.25 / 11 Mhz for NTSC "realtime."
+    // Run at 236.25 / 11 Mhz for NTSC "realtime", and at 26.6017125 Mhz
+    // for PAL and Dendy.
     std::optional<core::Pixel> execute();
     void reset();
+    // Switches to the region in the rom's header, NTSC by default. If that
+    // is a different region, the ppu and apu are replaced, losing e.g. the
+    // apu's sample sinks, so set them up again after loading.
     void load_rom(std::istream &bytestream);
+    // Battery backed prg ram is kept in save_path if it isn't empty.
+    void load_rom(const std::filesystem::path &rom_path,
+            const std::filesystem::path &save_path = {});
 
     n_e_s::core::IMos6502 &cpu();
     const n_e_s::core::IMos6502 &cpu() const;
@@ -62,7 +74,21 @@ public:
 
     uint64_t current_cycle() const;
 
+    // The profiler, if any, is sampled after every cpu cycle. Pass nullptr to
+    // stop profiling.
+    void set_cpu_profiler(n_e_s::core::CpuProfiler *profiler);
+
 private:
+    void set_rom(std::unique_ptr<n_e_s::core::IRom> rom);
+    void set_region(n_e_s::core::Timing timing);
+    void connect_apu();
+
+    template <typename Region>
+    std::optional<core::Pixel> execute_region();
+    // execute_region for the current region.
+    std::optional<core::Pixel> (Nes::*execute_)(){};
+    n_e_s::core::Timing region_;
+
     std::unique_ptr<n_e_s::core::IMmu> ppu_mmu_;
     std::unique_ptr<n_e_s::core::PpuRegisters> ppu_registers_;
     std::unique_ptr<n_e_s::core::IPpu> ppu_;
@@ -79,7 +105,10 @@ private:
     std::unique_ptr<n_e_s::core::INesController> controller1_;
     std::unique_ptr<n_e_s::core::INesController> controller2_;
 
+    n_e_s::core::CpuProfiler *cpu_profiler_{};
+
     uint64_t cycle_{};
+    uint64_t next_apu_sync_{};
 };
 
 } // namespace n_e_s::nes
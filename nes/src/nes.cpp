@@ -2,6 +2,7 @@
 
 #include "nes/core/apu_factory.h"
 #include "nes/core/cpu_factory.h"
+#include "nes/core/cpu_profiler.h"
 #include "nes/core/iapu.h"
 #include "nes/core/immu.h"
 #include "nes/core/imos6502.h"
@@ -13,6 +14,7 @@
 #include "nes/core/membank_factory.h"
 #include "nes/core/mmu_factory.h"
 #include "nes/core/ppu_factory.h"
+#include "nes/core/region.h"
 #include "nes/core/rom_factory.h"
 
 #include <fstream>
@@ -22,6 +24,9 @@ using namespace n_e_s::core;
 namespace n_e_s::nes {
 namespace {
 
+// In cpu cycles, about 2 ms.
+constexpr uint64_t kApuSyncInterval{4096};
+
 class MemBankReference : public IMemBank {
 public:
     explicit MemBankReference(IMemBank *const membank) : membank_(membank) {}
@@ -36,6 +41,21 @@ public:
     void write_byte(uint16_t addr, uint8_t byte) override {
         membank_->write_byte(addr, byte);
     }
+    void read_block(uint16_t addr, std::span<uint8_t> dst) const override {
+        membank_->read_block(addr, dst);
+    }
+    void write_block(uint16_t addr, std::span<const uint8_t> src) override {
+        membank_->write_block(addr, src);
+    }
+    void peek_block(uint16_t addr, std::span<uint8_t> dst) const override {
+        membank_->peek_block(addr, dst);
+    }
+    uint8_t peek_byte(uint16_t addr) const override {
+        return membank_->peek_byte(addr);
+    }
+    std::span<uint8_t> direct_memory(uint16_t addr) override {
+        return membank_->direct_memory(addr);
+    }
 
 private:
     IMemBank *membank_;
@@ -61,41 +81,129 @@ Nes::Nes()
     cpu_registers_->p = I_FLAG | FLAG_5;
     cpu_registers_->a = cpu_registers_->x = cpu_registers_->y = 0x00;
     cpu_registers_->sp = 0xFD;
+
+    region_ = Timing::Ntsc;
+    execute_ = &Nes::execute_region<Ntsc>;
+    connect_apu();
 }
 
 Nes::~Nes() = default;
 
-// https://wiki.nesdev.com/w/index.php/Cycle_reference_chart#Clock_rates
 std::optional<core::Pixel> Nes::execute() {
-    if (cycle_++ % 12 == 0) {
+    return (this->*execute_)();
+}
+
+// https://wiki.nesdev.com/w/index.php/Cycle_reference_chart#Clock_rates
+template <typename Region>
+std::optional<core::Pixel> Nes::execute_region() {
+    if (cycle_++ % Region::kCpuDivider == 0) {
         cpu_->execute();
+        if (cpu_profiler_ != nullptr) {
+            cpu_profiler_->sample(cpu_->state());
+        }
     }
 
-    // The APU runs at master clock % 24. (every other CPU tick)
-    if (cycle_ % 24 == 0) {
-        apu_->execute();
+    // The APU catches up by itself when its registers are accessed, so it
+    // only has to be run here to hand out audio in time.
+    if (cycle_ >= next_apu_sync_) {
+        apu_->run_until(cpu_->state().cycle);
+        next_apu_sync_ += kApuSyncInterval * Region::kCpuDivider;
     }
 
-    if (cycle_ % 4 == 0) {
+    if (cycle_ % Region::kPpuDivider == 0) {
         return ppu_->execute();
     }
 
     return {};
 }
 
+void Nes::connect_apu() {
+    apu_->set_cpu_clock([cpu = cpu_.get()] { return cpu->state().cycle; });
+    apu_->set_irq_handler([cpu = cpu_.get()](uint8_t sources, bool asserted) {
+        cpu->set_irq(sources, asserted);
+    });
+    apu_->set_irq_scheduler([cpu = cpu_.get()](uint8_t sources, uint64_t at) {
+        cpu->schedule_irq(sources, at);
+    });
+    apu_->set_dma_reader(
+            [mmu = mmu_.get()](uint16_t addr) { return mmu->read_byte(addr); });
+    apu_->set_dma_scheduler(
+            [cpu = cpu_.get()](std::optional<uint64_t> cycle) {
+                cpu->schedule_dma(cycle);
+            });
+    cpu_->set_dma_handler([cpu = cpu_.get(), apu = apu_.get()] {
+        apu->dma(cpu->state().cycle);
+    });
+}
+
+// The ppu and apu are replaced by ones made for the region, as their timing
+// is fixed at compile time. They're kept when the region doesn't change so
+// that e.g. the audio setup survives loading another rom.
+void Nes::set_region(Timing timing) {
+    if (timing == Timing::MultiRegion) {
+        timing = Timing::Ntsc;
+    }
+    if (timing == region_) {
+        return;
+    }
+    region_ = timing;
+
+    ppu_ = PpuFactory::create(ppu_registers_.get(), ppu_mmu_.get(), timing);
+    ppu_->set_nmi_handler([cpu = cpu_.get()] { cpu->set_nmi(true); });
+
+    cpu_->set_irq(IRQ_APU_FRAME_COUNTER | IRQ_APU_DMC, false);
+    apu_ = ApuFactory::create(timing);
+    // The apu counts cycles since power on, like the cpu. It's connected
+    // first so that the cpu sees the irqs raised while catching up.
+    connect_apu();
+    apu_->run_until(cpu_->state().cycle);
+
+    switch (timing) {
+    case Timing::Pal:
+        execute_ = &Nes::execute_region<Pal>;
+        break;
+    case Timing::Dendy:
+        execute_ = &Nes::execute_region<Dendy>;
+        break;
+    case Timing::Ntsc:
+    case Timing::MultiRegion:
+        execute_ = &Nes::execute_region<Ntsc>;
+        break;
+    }
+}
+
 void Nes::reset() {
     cpu_->reset();
 }
 
 void Nes::load_rom(std::istream &bytestream) {
-    rom_ = RomFactory::from_bytes(bytestream);
+    set_rom(RomFactory::from_bytes(bytestream));
+}
+
+void Nes::load_rom(const std::filesystem::path &rom_path,
+        const std::filesystem::path &save_path) {
+    set_rom(RomFactory::from_file(rom_path, save_path));
+}
+
+void Nes::set_rom(std::unique_ptr<n_e_s::core::IRom> rom) {
+    rom_ = std::move(rom);
+    set_region(rom_->header().timing());
+
+    cpu_->set_irq(IRQ_MAPPER, false);
+    rom_->set_irq_handler([cpu = cpu_.get()](bool asserted) {
+        cpu->set_irq(IRQ_MAPPER, asserted);
+    });
+    ppu_->set_a12_rise_handler([rom = rom_.get()] { rom->ppu_a12_rise(); });
 
     MemBankList ppu_membanks{
             MemBankFactory::create_nes_ppu_mem_banks(rom_.get())};
     ppu_mmu_->set_mem_banks(std::move(ppu_membanks));
 
-    MemBankList cpu_membanks{MemBankFactory::create_nes_mem_banks(
-            ppu_.get(), rom_.get(), controller1_.get(), controller2_.get())};
+    MemBankList cpu_membanks{MemBankFactory::create_nes_mem_banks(ppu_.get(),
+            apu_.get(),
+            rom_.get(),
+            controller1_.get(),
+            controller2_.get())};
     mmu_->set_mem_banks(std::move(cpu_membanks));
 
     reset();
@@ -167,4 +275,8 @@ uint64_t Nes::current_cycle() const {
     return cycle_;
 }
 
+void Nes::set_cpu_profiler(n_e_s::core::CpuProfiler *const profiler) {
+    cpu_profiler_ = profiler;
+}
+
 } // namespace n_e_s::nes
@@ -1,14 +1,83 @@
 #include "nes/nes.h"
 
+#include "nes/core/iapu.h"
+#include "nes/core/imos6502.h"
+#include "nes/core/ines_header.h"
+
 #include <gtest/gtest.h>
 
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <sstream>
+#include <string>
+
 using namespace n_e_s::nes;
 
 namespace {
 
+// An NROM rom that loops forever at $8000.
+std::string looping_rom(bool pal = false) {
+    n_e_s::core::INesHeader header{};
+    header.prg_rom_size = 1;
+    header.chr_rom_size = 1;
+    header.flags_6 = 0;
+    header.flags_7 = 0;
+    header.flags_8 = 0;
+    header.flags_9 = pal ? 0x01 : 0x00;
+    header.flags_10 = 0;
+
+    std::string bytes(sizeof(header), '\0');
+    std::memcpy(bytes.data(), &header, sizeof(header));
+
+    std::string prg(16 * 1024, '\0');
+    prg[0] = '\x4C'; // jmp $8000
+    prg[1] = '\x00';
+    prg[2] = '\x80';
+    prg[0x3FFC] = '\x00'; // Reset vector, $8000
+    prg[0x3FFD] = '\x80';
+    bytes += prg;
+    bytes.append(8 * 1024, '\0');
+    return bytes;
+}
+
 TEST(Nes, inital_state_is_correct) {
     Nes nes;
     EXPECT_EQ(0llu, nes.current_cycle());
 }
 
+TEST(Nes, sample_sink_survives_loading_a_rom_of_the_same_region) {
+    Nes nes;
+    std::size_t samples = 0;
+    nes.apu().set_sample_sink([&](std::span<const int16_t> block) {
+        samples += block.size();
+    });
+
+    std::stringstream rom(looping_rom());
+    nes.load_rom(rom);
+    // A few audio blocks worth of master clock cycles.
+    for (int i = 0; i < 12 * 4096 * 4; ++i) {
+        nes.execute();
+    }
+
+    EXPECT_GT(samples, 0u);
+}
+
+TEST(Nes, frame_irq_raised_while_switching_region_reaches_the_cpu) {
+    Nes nes;
+    std::stringstream rom(looping_rom());
+    nes.load_rom(rom);
+    // Enough cpu cycles for the pal apu's frame irq to be due.
+    for (int i = 0; i < 12 * 35000; ++i) {
+        nes.execute();
+    }
+
+    rom = std::stringstream(looping_rom(true));
+    nes.load_rom(rom);
+
+    EXPECT_TRUE(nes.cpu().irq_sources() &
+                n_e_s::core::IRQ_APU_FRAME_COUNTER);
+}
+
 } // namespace
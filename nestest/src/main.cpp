@@ -1,4 +1,6 @@
-#include <fstream>
+#include <array>
+#include <cstdint>
+#include <filesystem>
 #include <stdexcept>
 
 #include <fmt/core.h>
@@ -59,9 +61,9 @@ std::string get_reg_string(const n_e_s::core::CpuRegisters &reg) {
 std::string get_opcode_string(const n_e_s::nes::Nes &nes) {
     const n_e_s::core::IMos6502 &cpu = nes.cpu();
     const auto state = cpu.state();
-    const std::uint8_t raw_opcode = nes.mmu().read_byte(state.start_pc);
-    const std::uint8_t op1 = nes.mmu().read_byte(state.start_pc + 1u);
-    const std::uint8_t op2 = nes.mmu().read_byte(state.start_pc + 2u);
+    std::array<std::uint8_t, 3> bytes{};
+    nes.mmu().peek_block(state.start_pc, bytes);
+    const auto [raw_opcode, op1, op2] = bytes;
 
     std::string result =
             fmt::format("{:04X}  {:02X}", state.start_pc, raw_opcode);
@@ -118,8 +120,7 @@ int main(int argc, char **argv) {
 
     try {
         n_e_s::nes::Nes nes;
-        std::ifstream fs(argv[1], std::ios::binary);
-        nes.load_rom(fs);
+        nes.load_rom(std::filesystem::path(argv[1]));
         nes.cpu_registers().pc = 0xC000;
 
         n_e_s::core::CpuState prev_state{};
@@ -1,4 +1,5 @@
-#include <fstream>
+#include <array>
+#include <filesystem>
 #include <stdexcept>
 #include <string>
 
@@ -13,16 +14,17 @@
 namespace {
 
 void print_nametable(const n_e_s::nes::Nes &nes) {
+    // $2000-$23FF  Nametable 0
+    // $2400-$27FF  Nametable 1
+    // $2800-$2BFF  Nametable 2
+    // $2C00-$2FFF  Nametable 3
+    const int nametable = 0;
+    std::array<uint8_t, 32 * 30> tiles{};
+    nes.ppu_mmu().peek_block(0x2000 + 0x0400 * nametable, tiles);
+
     for (uint16_t y = 0; y < 30; ++y) {
         for (uint16_t x = 0; x < 32; ++x) {
-            // $2000-$23FF  Nametable 0
-            // $2400-$27FF  Nametable 1
-            // $2800-$2BFF  Nametable 2
-            // $2C00-$2FFF  Nametable 3
-            const int nametable = 0;
-            const uint16_t address = 0x2000 + 0x0400 * nametable + y * 32 + x;
-            const uint8_t tile_index = nes.ppu_mmu().read_byte(address);
-            fmt::print("{:02X},", tile_index);
+            fmt::print("{:02X},", tiles[y * 32u + x]);
         }
         fmt::print("\n");
     }
@@ -39,8 +41,7 @@ int main(int argc, char **argv) try {
     n_e_s::nes::Nes nes;
     const std::string rom = argv[1];
     const int cycles = std::stoi(argv[2]);
-    std::ifstream fs(rom, std::ios::binary);
-    nes.load_rom(fs);
+    nes.load_rom(std::filesystem::path(rom));
 
     fmt::print("Running rom: \"{}\"\n", rom);
     fmt::print("Cycles: \"{}\"\n", cycles);